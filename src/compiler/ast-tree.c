@@ -9,6 +9,7 @@
 #include "utils/time.h"
 #include "utils/type.h"
 #include <stdlib.h>
+#include <string.h>
 
 AstTree AST_TREE_TYPE_TYPE = {
     .token = AST_TREE_TOKEN_TYPE_TYPE,
@@ -173,6 +174,26 @@ const char *AST_TREE_TOKEN_STRINGS[] = {
     "AST_TREE_TOKEN_BUILTIN_IS_COMPTIME",
     "AST_TREE_TOKEN_BUILTIN_STACK_ALLOC",
     "AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC",
+    "AST_TREE_TOKEN_BUILTIN_FREE",
+    "AST_TREE_TOKEN_BUILTIN_FFI",
+    "AST_TREE_TOKEN_BUILTIN_SPAWN",
+    "AST_TREE_TOKEN_BUILTIN_JOIN",
+    "AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD",
+    "AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE",
+    "AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD",
+    "AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE",
+    "AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR",
+    "AST_TREE_TOKEN_BUILTIN_GETC",
+    "AST_TREE_TOKEN_BUILTIN_READ",
+    "AST_TREE_TOKEN_BUILTIN_MAP_FILE",
+    "AST_TREE_TOKEN_BUILTIN_UNMAP_FILE",
+    "AST_TREE_TOKEN_BUILTIN_MEMCPY",
+    "AST_TREE_TOKEN_BUILTIN_MEMSET",
+    "AST_TREE_TOKEN_BUILTIN_MEMCMP",
+    "AST_TREE_TOKEN_BUILTIN_SUM",
+    "AST_TREE_TOKEN_BUILTIN_MIN",
+    "AST_TREE_TOKEN_BUILTIN_MAX",
+    "AST_TREE_TOKEN_BUILTIN_DOT",
     "AST_TREE_TOKEN_BUILTIN_NEG",
     "AST_TREE_TOKEN_BUILTIN_ADD",
     "AST_TREE_TOKEN_BUILTIN_SUB",
@@ -230,6 +251,9 @@ const char *AST_TREE_TOKEN_STRINGS[] = {
     "AST_TREE_TOKEN_VALUE_FLOAT",
     "AST_TREE_TOKEN_VALUE_BOOL",
     "AST_TREE_TOKEN_VALUE_OBJECT",
+    "AST_TREE_TOKEN_RAW_VALUE",
+    "AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED",
+    "AST_TREE_TOKEN_THUNK",
 
     "AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT",
 
@@ -266,6 +290,8 @@ AstTreeRoots AST_TREE_ROOTS_ERROR = {
     .size = -1ULL,
 };
 
+_Thread_local bool AST_TREE_PRIVATE_COPIES = false;
+
 #ifdef PRINT_COMPILE_TREE
 void astTreePrint(const AstTree *tree, int indent) {
   for (int i = 0; i < indent; ++i)
@@ -315,6 +341,26 @@ void astTreePrint(const AstTree *tree, int indent) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -431,6 +477,28 @@ void astTreePrint(const AstTree *tree, int indent) {
     printf("]");
   }
     goto RETURN_SUCCESS;
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED: {
+    AstTreeRawValue *metadata = tree->metadata;
+    printf(",size=%ld", metadata->size);
+  }
+    goto RETURN_SUCCESS;
+  case AST_TREE_TOKEN_THUNK: {
+    AstTreeThunk *metadata = tree->metadata;
+    printf(",isByName=%b,\n", metadata->isByName);
+    for (int i = 0; i < indent; ++i)
+      printf(" ");
+    printf("expr=\n");
+    astTreePrint(metadata->expr, indent + 1);
+    if (metadata->value != NULL) {
+      printf(",\n");
+      for (int i = 0; i < indent; ++i)
+        printf(" ");
+      printf("value=\n");
+      astTreePrint(metadata->value, indent + 1);
+    }
+  }
+    goto RETURN_SUCCESS;
   case AST_TREE_TOKEN_TYPE_FUNCTION: {
     AstTreeTypeFunction *metadata = tree->metadata;
     printf(",\n");
@@ -728,6 +796,9 @@ void astTreeDestroy(AstTree tree) {
   if (tree.type != NULL) {
     astTreeDelete(tree.type);
   }
+  if (tree.constValue != NULL) {
+    astTreeDelete(tree.constValue);
+  }
   switch (tree.token) {
   case AST_TREE_TOKEN_FUNCTION: {
     AstTreeFunction *metadata = tree.metadata;
@@ -741,6 +812,26 @@ void astTreeDestroy(AstTree tree) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -804,17 +895,17 @@ void astTreeDestroy(AstTree tree) {
   }
   case AST_TREE_TOKEN_VALUE_BOOL: {
     AstTreeBool *metadata = tree.metadata;
-    free(metadata);
+    a404m_slab_free(metadata, sizeof(*metadata));
     return;
   }
   case AST_TREE_TOKEN_VALUE_INT: {
     AstTreeInt *metadata = tree.metadata;
-    free(metadata);
+    a404m_slab_free(metadata, sizeof(*metadata));
     return;
   }
   case AST_TREE_TOKEN_VALUE_FLOAT: {
     AstTreeFloat *metadata = tree.metadata;
-    free(metadata);
+    a404m_slab_free(metadata, sizeof(*metadata));
     return;
   }
   case AST_TREE_TOKEN_VALUE_OBJECT: {
@@ -827,6 +918,25 @@ void astTreeDestroy(AstTree tree) {
     free(metadata);
     return;
   }
+  case AST_TREE_TOKEN_RAW_VALUE: {
+    AstTreeRawValue *metadata = tree.metadata;
+    rawDataDelete(metadata->data);
+    free(metadata);
+    return;
+  }
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED: {
+    AstTreeRawValue *metadata = tree.metadata;
+    free(metadata);
+    return;
+  }
+  case AST_TREE_TOKEN_THUNK: {
+    AstTreeThunk *metadata = tree.metadata;
+    if (metadata->value != NULL) {
+      astTreeDelete(metadata->value);
+    }
+    free(metadata);
+    return;
+  }
   case AST_TREE_TOKEN_OPERATOR_LOGICAL_NOT:
   case AST_TREE_TOKEN_OPERATOR_PLUS:
   case AST_TREE_TOKEN_OPERATOR_MINUS: {
@@ -933,6 +1043,7 @@ void astTreeDestroy(AstTree tree) {
       astTreeVariableDelete(metadata->variables.data[i]);
     }
     free(metadata->variables.data);
+    free(metadata->offsets);
     free(metadata);
   }
     return;
@@ -979,13 +1090,13 @@ void astTreeVariableDestroy(AstTreeVariable variable) {
 
 void astTreeVariableDelete(AstTreeVariable *variable) {
   astTreeVariableDestroy(*variable);
-  free(variable);
+  a404m_slab_free(variable, sizeof(*variable));
 }
 
 void astTreeDelete(AstTree *tree) {
   if (astTreeShouldDelete(tree)) {
     astTreeDestroy(*tree);
-    free(tree);
+    a404m_slab_free(tree, sizeof(*tree));
   }
 }
 
@@ -1028,13 +1139,14 @@ void astTreeRootsDestroy(AstTreeRoots roots) {
 
 AstTree *newAstTree(AstTreeToken token, void *metadata, AstTree *type,
                     char const *str_begin, char const *str_end) {
-  AstTree *result = a404m_malloc(sizeof(*result));
+  AstTree *result = a404m_slab_malloc(sizeof(*result));
   *result = (AstTree){
       .token = token,
       .metadata = metadata,
       .type = type,
       .str_begin = str_begin,
       .str_end = str_end,
+      .constValue = NULL,
   };
   return result;
 }
@@ -1047,6 +1159,12 @@ AstTree *copyAstTreeWithCheck(AstTree *tree) {
   return copyAstTreeBack(tree, NULL, NULL, 0, true);
 }
 
+static AstTreeVariables copyAstTreeLocals(AstTreeVariables variables,
+                                          AstTreeVariables oldVariables[],
+                                          AstTreeVariables newVariables[],
+                                          size_t variables_size,
+                                          bool safetyCheck);
+
 AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
                          AstTreeVariables newVariables[], size_t variables_size,
                          bool safetyCheck) {
@@ -1088,6 +1206,26 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -1152,7 +1290,7 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
   }
   case AST_TREE_TOKEN_VALUE_BOOL: {
     AstTreeBool *metadata = tree->metadata;
-    AstTreeBool *newMetadata = a404m_malloc(sizeof(*newMetadata));
+    AstTreeBool *newMetadata = a404m_slab_malloc(sizeof(*newMetadata));
     *newMetadata = *metadata;
     return newAstTree(tree->token, newMetadata,
                       copyAstTreeBack(tree->type, oldVariables, newVariables,
@@ -1161,7 +1299,7 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
   }
   case AST_TREE_TOKEN_VALUE_INT: {
     AstTreeInt *metadata = tree->metadata;
-    AstTreeInt *newMetadata = a404m_malloc(sizeof(*newMetadata));
+    AstTreeInt *newMetadata = a404m_slab_malloc(sizeof(*newMetadata));
     *newMetadata = *metadata;
     return newAstTree(tree->token, newMetadata,
                       copyAstTreeBack(tree->type, oldVariables, newVariables,
@@ -1170,7 +1308,7 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
   }
   case AST_TREE_TOKEN_VALUE_FLOAT: {
     AstTreeFloat *metadata = tree->metadata;
-    AstTreeFloat *newMetadata = a404m_malloc(sizeof(*newMetadata));
+    AstTreeFloat *newMetadata = a404m_slab_malloc(sizeof(*newMetadata));
     *newMetadata = *metadata;
     return newAstTree(tree->token, newMetadata,
                       copyAstTreeBack(tree->type, oldVariables, newVariables,
@@ -1190,6 +1328,42 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
                                       variables_size, safetyCheck),
                       tree->str_begin, tree->str_end);
   }
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED: {
+    AstTreeRawValue *metadata = tree->metadata;
+    AstTreeRawValue *newMetadata = a404m_malloc(sizeof(*newMetadata));
+
+    newMetadata->size = metadata->size;
+    if (tree->token == AST_TREE_TOKEN_RAW_VALUE) {
+      newMetadata->data = rawDataShare(metadata->data);
+    } else {
+      newMetadata->data = metadata->data;
+    }
+
+    return newAstTree(tree->token, newMetadata,
+                      copyAstTreeBack(tree->type, oldVariables, newVariables,
+                                      variables_size, safetyCheck),
+                      tree->str_begin, tree->str_end);
+  }
+  case AST_TREE_TOKEN_THUNK: {
+    AstTreeThunk *metadata = tree->metadata;
+    AstTreeThunk *newMetadata = a404m_malloc(sizeof(*newMetadata));
+
+    newMetadata->expr = metadata->expr;
+    newMetadata->isByName = metadata->isByName;
+    if (metadata->value != NULL) {
+      newMetadata->value =
+          copyAstTreeBack(metadata->value, oldVariables, newVariables,
+                          variables_size, safetyCheck);
+    } else {
+      newMetadata->value = NULL;
+    }
+
+    return newAstTree(tree->token, newMetadata,
+                      copyAstTreeBack(tree->type, oldVariables, newVariables,
+                                      variables_size, safetyCheck),
+                      tree->str_begin, tree->str_end);
+  }
   case AST_TREE_TOKEN_VARIABLE:
   case AST_TREE_TOKEN_VARIABLE_DEFINE: {
     AstTreeVariable *variable = tree->metadata;
@@ -1248,6 +1422,7 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
                         variables_size, safetyCheck);
     new_metadata->function = copyAstTreeBackFindVariable(
         metadata->function, oldVariables, newVariables, variables_size);
+    new_metadata->builtin = metadata->builtin;
     return newAstTree(tree->token, new_metadata,
                       copyAstTreeBack(tree->type, oldVariables, newVariables,
                                       variables_size, safetyCheck),
@@ -1258,8 +1433,8 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
     AstTreeFunction *new_metadata = a404m_malloc(sizeof(*new_metadata));
 
     new_metadata->arguments =
-        copyAstTreeVariables(metadata->arguments, oldVariables, newVariables,
-                             variables_size, safetyCheck);
+        copyAstTreeLocals(metadata->arguments, oldVariables, newVariables,
+                          variables_size, safetyCheck);
 
     size_t new_variables_size = variables_size + 2;
     AstTreeVariables new_oldVariables[new_variables_size];
@@ -1279,10 +1454,14 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
     new_metadata->returnType =
         copyAstTreeBack(metadata->returnType, new_oldVariables,
                         new_newVariables, new_variables_size, safetyCheck);
+    new_metadata->slots_size = metadata->slots_size;
+    new_metadata->running = 0;
+    new_metadata->isLeaf = metadata->isLeaf;
+    new_metadata->isPrivate = AST_TREE_PRIVATE_COPIES;
 
     new_metadata->scope.variables =
-        copyAstTreeVariables(metadata->scope.variables, new_oldVariables,
-                             new_newVariables, new_variables_size, safetyCheck);
+        copyAstTreeLocals(metadata->scope.variables, new_oldVariables,
+                          new_newVariables, new_variables_size, safetyCheck);
     new_metadata->scope.expressions_size = metadata->scope.expressions_size;
     new_metadata->scope.expressions =
         a404m_malloc(new_metadata->scope.expressions_size *
@@ -1313,6 +1492,7 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
                         variables_size, safetyCheck);
     new_metadata->function = copyAstTreeBackFindVariable(
         metadata->function, oldVariables, newVariables, variables_size);
+    new_metadata->builtin = metadata->builtin;
 
     return newAstTree(tree->token, new_metadata,
                       copyAstTreeBack(tree->type, oldVariables, newVariables,
@@ -1412,8 +1592,8 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
     AstTreeScope *new_metadata = a404m_malloc(sizeof(*new_metadata));
 
     new_metadata->variables =
-        copyAstTreeVariables(metadata->variables, oldVariables, newVariables,
-                             variables_size, safetyCheck);
+        copyAstTreeLocals(metadata->variables, oldVariables, newVariables,
+                          variables_size, safetyCheck);
     new_metadata->expressions_size = metadata->expressions_size;
     new_metadata->expressions = a404m_malloc(
         new_metadata->expressions_size * sizeof(*new_metadata->expressions));
@@ -1449,6 +1629,15 @@ AstTree *copyAstTreeBack(AstTree *tree, AstTreeVariables oldVariables[],
         copyAstTreeVariables(metadata->variables, oldVariables, newVariables,
                              variables_size, safetyCheck);
     new_metadata->id = metadata->id;
+    new_metadata->size = metadata->size;
+    if (metadata->offsets == NULL) {
+      new_metadata->offsets = NULL;
+    } else {
+      const size_t size =
+          metadata->variables.size * sizeof(*new_metadata->offsets);
+      new_metadata->offsets = a404m_malloc(size);
+      memcpy(new_metadata->offsets, metadata->offsets, size);
+    }
 
     return newAstTree(tree->token, new_metadata,
                       copyAstTreeBack(tree->type, oldVariables, newVariables,
@@ -1527,10 +1716,16 @@ AstTreeVariable *copyAstTreeBackFindVariable(AstTreeVariable *variable,
   return variable;
 }
 
-AstTreeVariables copyAstTreeVariables(AstTreeVariables variables,
-                                      AstTreeVariables oldVariables[],
-                                      AstTreeVariables newVariables[],
-                                      size_t variables_size, bool safetyCheck) {
+// set while copying a function for another thread, the values of the non
+// const locals belong to the calls that are running, they are not even read
+// since those calls write them meanwhile, and the copy sets them before it
+// reads them
+static _Thread_local bool COPY_WITHOUT_LOCALS = false;
+
+static AstTreeVariables copyAstTreeVariablesBack(
+    AstTreeVariables variables, AstTreeVariables oldVariables[],
+    AstTreeVariables newVariables[], size_t variables_size, bool safetyCheck,
+    bool isLocals) {
   AstTreeVariables result = {
       .data = a404m_malloc(variables.size * sizeof(*variables.data)),
       .size = variables.size,
@@ -1547,15 +1742,19 @@ AstTreeVariables copyAstTreeVariables(AstTreeVariables variables,
   new_newVariables[new_variables_size - 1] = result;
 
   for (size_t i = 0; i < result.size; ++i) {
-    result.data[i] = a404m_malloc(sizeof(*result.data[i]));
+    result.data[i] = a404m_slab_malloc(sizeof(*result.data[i]));
     result.data[i]->name_begin = variables.data[i]->name_begin;
     result.data[i]->name_end = variables.data[i]->name_end;
     result.data[i]->isConst = variables.data[i]->isConst;
     result.data[i]->isLazy = variables.data[i]->isLazy;
+    result.data[i]->isByName = variables.data[i]->isByName;
+    result.data[i]->isGlobal = variables.data[i]->isGlobal;
+    result.data[i]->slot = variables.data[i]->slot;
     result.data[i]->type =
         copyAstTreeBack(variables.data[i]->type, new_oldVariables,
                         new_newVariables, new_variables_size, safetyCheck);
-    if (variables.data[i]->value != NULL) {
+    if ((!isLocals || !COPY_WITHOUT_LOCALS || variables.data[i]->isConst) &&
+        variables.data[i]->value != NULL) {
       result.data[i]->value =
           copyAstTreeBack(variables.data[i]->value, new_oldVariables,
                           new_newVariables, new_variables_size, safetyCheck);
@@ -1574,6 +1773,23 @@ AstTreeVariables copyAstTreeVariables(AstTreeVariables variables,
   return result;
 }
 
+AstTreeVariables copyAstTreeVariables(AstTreeVariables variables,
+                                      AstTreeVariables oldVariables[],
+                                      AstTreeVariables newVariables[],
+                                      size_t variables_size, bool safetyCheck) {
+  return copyAstTreeVariablesBack(variables, oldVariables, newVariables,
+                                  variables_size, safetyCheck, false);
+}
+
+static AstTreeVariables copyAstTreeLocals(AstTreeVariables variables,
+                                          AstTreeVariables oldVariables[],
+                                          AstTreeVariables newVariables[],
+                                          size_t variables_size,
+                                          bool safetyCheck) {
+  return copyAstTreeVariablesBack(variables, oldVariables, newVariables,
+                                  variables_size, safetyCheck, true);
+}
+
 AstTreeFunction *copyAstTreeFunction(AstTreeFunction *metadata,
                                      AstTreeVariables oldVariables[],
                                      AstTreeVariables newVariables[],
@@ -1581,8 +1797,8 @@ AstTreeFunction *copyAstTreeFunction(AstTreeFunction *metadata,
   AstTreeFunction *new_metadata = a404m_malloc(sizeof(*new_metadata));
 
   new_metadata->arguments =
-      copyAstTreeVariables(metadata->arguments, oldVariables, newVariables,
-                           variables_size, safetyCheck);
+      copyAstTreeLocals(metadata->arguments, oldVariables, newVariables,
+                        variables_size, safetyCheck);
 
   const size_t new_variables_size = variables_size + 2;
   AstTreeVariables new_oldVariables[new_variables_size];
@@ -1602,10 +1818,14 @@ AstTreeFunction *copyAstTreeFunction(AstTreeFunction *metadata,
   new_metadata->returnType =
       copyAstTreeBack(metadata->returnType, new_oldVariables, new_newVariables,
                       new_variables_size, safetyCheck);
+  new_metadata->slots_size = metadata->slots_size;
+  new_metadata->running = 0;
+  new_metadata->isLeaf = metadata->isLeaf;
+  new_metadata->isPrivate = AST_TREE_PRIVATE_COPIES;
 
   new_metadata->scope.variables =
-      copyAstTreeVariables(metadata->scope.variables, new_oldVariables,
-                           new_newVariables, new_variables_size, safetyCheck);
+      copyAstTreeLocals(metadata->scope.variables, new_oldVariables,
+                        new_newVariables, new_variables_size, safetyCheck);
   new_metadata->scope.expressions_size = metadata->scope.expressions_size;
   new_metadata->scope.expressions =
       a404m_malloc(new_metadata->scope.expressions_size *
@@ -1622,6 +1842,16 @@ AstTreeFunction *copyAstTreeFunction(AstTreeFunction *metadata,
   return new_metadata;
 }
 
+AstTreeFunction *copyAstTreeFunctionForThread(AstTreeFunction *function) {
+  const bool wasPrivate = AST_TREE_PRIVATE_COPIES;
+  AST_TREE_PRIVATE_COPIES = true;
+  COPY_WITHOUT_LOCALS = true;
+  AstTreeFunction *result = copyAstTreeFunction(function, NULL, NULL, 0, false);
+  COPY_WITHOUT_LOCALS = false;
+  AST_TREE_PRIVATE_COPIES = wasPrivate;
+  return result;
+}
+
 AstTreeRoots makeAstTree(const char *filePath
 #ifdef PRINT_STATISTICS
                          ,
@@ -1886,11 +2116,14 @@ AstTreeRoot *makeAstRoot(const ParserNode *parsedRoot, char *filePath) {
                node->token == PARSER_TOKEN_VARIABLE) {
       ParserNodeVariableMetadata *node_metadata = node->metadata;
 
-      AstTreeVariable *variable = a404m_malloc(sizeof(*variable));
+      AstTreeVariable *variable = a404m_slab_malloc(sizeof(*variable));
       variable->name_begin = node_metadata->name->str_begin;
       variable->name_end = node_metadata->name->str_end;
       variable->isConst = node->token == PARSER_TOKEN_CONSTANT;
       variable->isLazy = node_metadata->isLazy;
+      variable->isByName = node_metadata->isByName;
+      variable->isGlobal = true;
+      variable->slot = 0;
 
       if (node_metadata->isComptime && !variable->isConst) {
         printError(node->str_begin, node->str_end, "Bad comptime %s",
@@ -2038,6 +2271,26 @@ AstTreeRoot *makeAstRoot(const ParserNode *parsedRoot, char *filePath) {
       case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
       case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
       case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+      case PARSER_TOKEN_BUILTIN_FREE:
+      case PARSER_TOKEN_BUILTIN_FFI:
+      case PARSER_TOKEN_BUILTIN_SPAWN:
+      case PARSER_TOKEN_BUILTIN_JOIN:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+      case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+      case PARSER_TOKEN_BUILTIN_GETC:
+      case PARSER_TOKEN_BUILTIN_READ:
+      case PARSER_TOKEN_BUILTIN_MAP_FILE:
+      case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+      case PARSER_TOKEN_BUILTIN_MEMCPY:
+      case PARSER_TOKEN_BUILTIN_MEMSET:
+      case PARSER_TOKEN_BUILTIN_MEMCMP:
+      case PARSER_TOKEN_BUILTIN_SUM:
+      case PARSER_TOKEN_BUILTIN_MIN:
+      case PARSER_TOKEN_BUILTIN_MAX:
+      case PARSER_TOKEN_BUILTIN_DOT:
       case PARSER_TOKEN_BUILTIN_NEG:
       case PARSER_TOKEN_BUILTIN_ADD:
       case PARSER_TOKEN_BUILTIN_SUB:
@@ -2146,6 +2399,48 @@ AstTree *astTreeParse(const ParserNode *parserNode) {
     return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_STACK_ALLOC);
   case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
     return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC);
+  case PARSER_TOKEN_BUILTIN_FREE:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_FREE);
+  case PARSER_TOKEN_BUILTIN_FFI:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_FFI);
+  case PARSER_TOKEN_BUILTIN_SPAWN:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_SPAWN);
+  case PARSER_TOKEN_BUILTIN_JOIN:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_JOIN);
+  case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD);
+  case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE);
+  case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD);
+  case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    return astTreeParseKeyword(parserNode,
+                               AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE);
+  case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+    return astTreeParseKeyword(parserNode,
+                               AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR);
+  case PARSER_TOKEN_BUILTIN_GETC:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_GETC);
+  case PARSER_TOKEN_BUILTIN_READ:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_READ);
+  case PARSER_TOKEN_BUILTIN_MAP_FILE:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_MAP_FILE);
+  case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_UNMAP_FILE);
+  case PARSER_TOKEN_BUILTIN_MEMCPY:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_MEMCPY);
+  case PARSER_TOKEN_BUILTIN_MEMSET:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_MEMSET);
+  case PARSER_TOKEN_BUILTIN_MEMCMP:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_MEMCMP);
+  case PARSER_TOKEN_BUILTIN_SUM:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_SUM);
+  case PARSER_TOKEN_BUILTIN_MIN:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_MIN);
+  case PARSER_TOKEN_BUILTIN_MAX:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_MAX);
+  case PARSER_TOKEN_BUILTIN_DOT:
+    return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_DOT);
   case PARSER_TOKEN_BUILTIN_NEG:
     return astTreeParseKeyword(parserNode, AST_TREE_TOKEN_BUILTIN_NEG);
   case PARSER_TOKEN_BUILTIN_ADD:
@@ -2308,8 +2603,8 @@ AstTree *astTreeParse(const ParserNode *parserNode) {
   case PARSER_TOKEN_OPERATOR_MINUS:
     return astTreeParseUnaryOperator(parserNode, AST_TREE_TOKEN_OPERATOR_MINUS);
   case PARSER_TOKEN_OPERATOR_POINTER:
-    return astTreeParseUnaryOperator(parserNode,
-                                     AST_TREE_TOKEN_OPERATOR_POINTER);
+    return astTreeParseUnaryOperatorSingleChild(
+        parserNode, AST_TREE_TOKEN_OPERATOR_POINTER);
   case PARSER_TOKEN_OPERATOR_ADDRESS:
     return astTreeParseUnaryOperatorSingleChild(
         parserNode, AST_TREE_TOKEN_OPERATOR_ADDRESS);
@@ -2364,6 +2659,10 @@ AstTree *astTreeParseFunction(const ParserNode *parserNode) {
 
   function->arguments.data = a404m_malloc(0);
   function->arguments.size = 0;
+  function->slots_size = 0;
+  function->running = 0;
+  function->isLeaf = false;
+  function->isPrivate = false;
 
   for (size_t i = 0; i < node_arguments->size; ++i) {
     const ParserNode *arg = node_arguments->data[i];
@@ -2383,7 +2682,7 @@ AstTree *astTreeParseFunction(const ParserNode *parserNode) {
       goto RETURN_ERROR;
     }
 
-    AstTreeVariable *argument = a404m_malloc(sizeof(*argument));
+    AstTreeVariable *argument = a404m_slab_malloc(sizeof(*argument));
     argument->value = NULL;
     argument->initValue = NULL;
     argument->type = type;
@@ -2391,6 +2690,9 @@ AstTree *astTreeParseFunction(const ParserNode *parserNode) {
     argument->name_end = arg_metadata->name->str_end;
     argument->isConst = arg_metadata->isComptime;
     argument->isLazy = arg_metadata->isLazy;
+    argument->isByName = arg_metadata->isByName;
+    argument->isGlobal = false;
+    argument->slot = i;
 
     if (!pushVariable(&function->arguments, argument)) {
       astTreeVariableDelete(argument);
@@ -2487,6 +2789,26 @@ AstTree *astTreeParseFunction(const ParserNode *parserNode) {
     case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
     case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
     case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+    case PARSER_TOKEN_BUILTIN_FREE:
+    case PARSER_TOKEN_BUILTIN_FFI:
+    case PARSER_TOKEN_BUILTIN_SPAWN:
+    case PARSER_TOKEN_BUILTIN_JOIN:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+    case PARSER_TOKEN_BUILTIN_GETC:
+    case PARSER_TOKEN_BUILTIN_READ:
+    case PARSER_TOKEN_BUILTIN_MAP_FILE:
+    case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+    case PARSER_TOKEN_BUILTIN_MEMCPY:
+    case PARSER_TOKEN_BUILTIN_MEMSET:
+    case PARSER_TOKEN_BUILTIN_MEMCMP:
+    case PARSER_TOKEN_BUILTIN_SUM:
+    case PARSER_TOKEN_BUILTIN_MIN:
+    case PARSER_TOKEN_BUILTIN_MAX:
+    case PARSER_TOKEN_BUILTIN_DOT:
     case PARSER_TOKEN_BUILTIN_NEG:
     case PARSER_TOKEN_BUILTIN_ADD:
     case PARSER_TOKEN_BUILTIN_SUB:
@@ -2676,7 +2998,7 @@ AstTree *astTreeParseIdentifier(const ParserNode *parserNode) {
 
 AstTree *astTreeParseValue(const ParserNode *parserNode, AstTreeToken token,
                            size_t metadata_size, AstTree *type) {
-  u8 *metadata = a404m_malloc(metadata_size);
+  u8 *metadata = a404m_slab_malloc(metadata_size);
   for (size_t i = 0; i < metadata_size; ++i) {
     metadata[i] = ((u8 *)parserNode->metadata)[i];
   }
@@ -2685,37 +3007,30 @@ AstTree *astTreeParseValue(const ParserNode *parserNode, AstTreeToken token,
                     parserNode->str_end);
 }
 
+// literals without escapes point into the source and the others own their
+// bytes
 AstTree *astTreeParseString(const ParserNode *parserNode) {
   ParserNodeStringMetadata *node_metadata = parserNode->metadata;
 
-  AstTreeObject *metadata = a404m_malloc(sizeof(*metadata));
+  AstTreeRawValue *metadata = a404m_malloc(sizeof(*metadata));
+  metadata->size = node_metadata->end - node_metadata->begin;
 
-  metadata->variables.size = node_metadata->end - node_metadata->begin;
-  metadata->variables.data = a404m_malloc(metadata->variables.size *
-                                          sizeof(*metadata->variables.data));
-
-  for (size_t i = 0; i < metadata->variables.size; ++i) {
-    AstTreeInt *cellMetadata = a404m_malloc(sizeof(*cellMetadata));
-    *cellMetadata = node_metadata->begin[i];
-
-    metadata->variables.data[i] =
-        a404m_malloc(sizeof(*metadata->variables.data[i]));
-    metadata->variables.data[i]->isConst = true;
-    metadata->variables.data[i]->isLazy = false;
-    metadata->variables.data[i]->name_begin = NULL;
-    metadata->variables.data[i]->name_end = NULL;
-    metadata->variables.data[i]->type = copyAstTree(&AST_TREE_U8_TYPE);
-    metadata->variables.data[i]->value =
-        newAstTree(AST_TREE_TOKEN_VALUE_INT, cellMetadata,
-                   copyAstTree(&AST_TREE_U8_TYPE), NULL, NULL);
-    metadata->variables.data[i]->initValue = NULL;
+  AstTreeToken token = AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED;
+  if (parserNode->str_end - parserNode->str_begin - 2 ==
+      (ptrdiff_t)metadata->size) {
+    metadata->data = (u8 *)parserNode->str_begin + 1;
+  } else {
+    token = AST_TREE_TOKEN_RAW_VALUE;
+    metadata->data = newRawData(metadata->size);
+    memcpy(metadata->data, node_metadata->begin, metadata->size);
   }
 
   AstTreeBracket *type_metadata = a404m_malloc(sizeof(*type_metadata));
   type_metadata->operand = &AST_TREE_U8_TYPE;
 
-  AstTreeInt *parameter_metadata = a404m_malloc(sizeof(*parameter_metadata));
-  *parameter_metadata = metadata->variables.size;
+  AstTreeInt *parameter_metadata =
+      a404m_slab_malloc(sizeof(*parameter_metadata));
+  *parameter_metadata = metadata->size;
   AstTree *parameter = newAstTree(AST_TREE_TOKEN_VALUE_INT, parameter_metadata,
                                   &AST_TREE_I64_TYPE, NULL, NULL);
 
@@ -2724,7 +3039,7 @@ AstTree *astTreeParseString(const ParserNode *parserNode) {
       type_metadata->parameters.size * sizeof(*type_metadata->parameters.data));
   type_metadata->parameters.data[0] = parameter;
 
-  return newAstTree(AST_TREE_TOKEN_VALUE_OBJECT, metadata,
+  return newAstTree(token, metadata,
                     newAstTree(AST_TREE_TOKEN_TYPE_ARRAY, type_metadata,
                                &AST_TREE_TYPE_TYPE, NULL, NULL),
                     parserNode->str_begin, parserNode->str_end);
@@ -2792,6 +3107,7 @@ AstTree *astTreeParseBinaryOperator(const ParserNode *parserNode,
   metadata->left = left;
   metadata->right = right;
   metadata->function = NULL;
+  metadata->builtin = AST_TREE_TOKEN_NONE;
 
   return newAstTree(token, metadata, NULL, parserNode->str_begin,
                     parserNode->str_end);
@@ -2808,6 +3124,7 @@ AstTree *astTreeParseUnaryOperator(const ParserNode *parserNode,
     return NULL;
   }
   metadata->function = NULL;
+  metadata->builtin = AST_TREE_TOKEN_NONE;
 
   return newAstTree(token, metadata, NULL, parserNode->str_begin,
                     parserNode->str_end);
@@ -2844,6 +3161,7 @@ AstTree *astTreeParseOperateAssignOperator(const ParserNode *parserNode,
   metadata->left = left;
   metadata->right = right;
   metadata->function = NULL;
+  metadata->builtin = AST_TREE_TOKEN_NONE;
 
   AstTreeInfix *assignMetadata = a404m_malloc(sizeof(*assignMetadata));
 
@@ -2854,6 +3172,7 @@ AstTree *astTreeParseOperateAssignOperator(const ParserNode *parserNode,
   assignMetadata->left = assignLeft;
   assignMetadata->right = assignRight;
   assignMetadata->function = NULL;
+  assignMetadata->builtin = AST_TREE_TOKEN_NONE;
 
   return newAstTree(AST_TREE_TOKEN_OPERATOR_ASSIGN, assignMetadata, NULL,
                     parserNode->str_begin, parserNode->str_end);
@@ -2884,7 +3203,7 @@ bool astTreeParseConstant(const ParserNode *parserNode,
     }
   }
 
-  AstTreeVariable *variable = a404m_malloc(sizeof(*variable));
+  AstTreeVariable *variable = a404m_slab_malloc(sizeof(*variable));
   variable->type = type;
   variable->value = value;
   variable->initValue = NULL;
@@ -2892,6 +3211,9 @@ bool astTreeParseConstant(const ParserNode *parserNode,
   variable->name_end = node_metadata->name->str_end;
   variable->isConst = true;
   variable->isLazy = node_metadata->isLazy;
+  variable->isByName = node_metadata->isByName;
+  variable->isGlobal = false;
+  variable->slot = 0;
 
   if (!pushVariable(variables, variable)) {
     astTreeVariableDelete(variable);
@@ -2936,7 +3258,7 @@ AstTree *astTreeParseVariable(const ParserNode *parserNode,
     }
   }
 
-  AstTreeVariable *variable = a404m_malloc(sizeof(*variable));
+  AstTreeVariable *variable = a404m_slab_malloc(sizeof(*variable));
   variable->type = type;
   variable->value = NULL;
   variable->initValue = value;
@@ -2944,6 +3266,9 @@ AstTree *astTreeParseVariable(const ParserNode *parserNode,
   variable->name_end = node_metadata->name->str_end;
   variable->isConst = false;
   variable->isLazy = node_metadata->isLazy;
+  variable->isByName = node_metadata->isByName;
+  variable->isGlobal = false;
+  variable->slot = 0;
 
   if (!pushVariable(variables, variable)) {
     astTreeVariableDelete(variable);
@@ -3114,6 +3439,26 @@ AstTree *astTreeParseCurlyBracket(const ParserNode *parserNode) {
     case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
     case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
     case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+    case PARSER_TOKEN_BUILTIN_FREE:
+    case PARSER_TOKEN_BUILTIN_FFI:
+    case PARSER_TOKEN_BUILTIN_SPAWN:
+    case PARSER_TOKEN_BUILTIN_JOIN:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+    case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+    case PARSER_TOKEN_BUILTIN_GETC:
+    case PARSER_TOKEN_BUILTIN_READ:
+    case PARSER_TOKEN_BUILTIN_MAP_FILE:
+    case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+    case PARSER_TOKEN_BUILTIN_MEMCPY:
+    case PARSER_TOKEN_BUILTIN_MEMSET:
+    case PARSER_TOKEN_BUILTIN_MEMCMP:
+    case PARSER_TOKEN_BUILTIN_SUM:
+    case PARSER_TOKEN_BUILTIN_MIN:
+    case PARSER_TOKEN_BUILTIN_MAX:
+    case PARSER_TOKEN_BUILTIN_DOT:
     case PARSER_TOKEN_BUILTIN_NEG:
     case PARSER_TOKEN_BUILTIN_ADD:
     case PARSER_TOKEN_BUILTIN_SUB:
@@ -3214,7 +3559,7 @@ AstTree *astTreeParseStruct(const ParserNode *parserNode) {
     }
     ParserNodeVariableMetadata *node_variable = node->metadata;
 
-    AstTreeVariable *variable = a404m_malloc(sizeof(*variable));
+    AstTreeVariable *variable = a404m_slab_malloc(sizeof(*variable));
     variable->name_begin = node_variable->name->str_begin;
     variable->name_end = node_variable->name->str_end;
     if (node_variable->type != NULL) {
@@ -3245,6 +3590,9 @@ AstTree *astTreeParseStruct(const ParserNode *parserNode) {
       variable->isConst = false;
     }
     variable->isLazy = node_variable->isLazy;
+    variable->isByName = node_variable->isByName;
+    variable->isGlobal = false;
+    variable->slot = 0;
 
     variables.data[i] = variable;
   }
@@ -3252,6 +3600,8 @@ AstTree *astTreeParseStruct(const ParserNode *parserNode) {
   AstTreeStruct *metadata = a404m_malloc(sizeof(*metadata));
   metadata->variables = variables;
   metadata->id = (size_t)metadata; // TODO: change it
+  metadata->offsets = NULL;
+  metadata->size = 0;
 
   return newAstTree(AST_TREE_TOKEN_KEYWORD_STRUCT, metadata, NULL,
                     parserNode->str_begin, parserNode->str_end);
@@ -3323,6 +3673,284 @@ bool isShapeShifter(AstTreeFunction *function) {
   return false;
 }
 
+// finds overloads like `(a:T,b:T) -> T { return @add(a,b); }` so the runner
+// can skip the call and run the kernel of the builtin directly
+AstTreeToken getForwardedBuiltin(AstTreeVariable *variable) {
+  if (!variable->isConst || variable->value == NULL ||
+      variable->value->token != AST_TREE_TOKEN_FUNCTION) {
+    return AST_TREE_TOKEN_NONE;
+  }
+  AstTreeFunction *function = variable->value->metadata;
+  if (function->scope.expressions_size != 1 ||
+      function->scope.expressions[0]->token != AST_TREE_TOKEN_KEYWORD_RETURN) {
+    return AST_TREE_TOKEN_NONE;
+  }
+  AstTreeReturn *ret = function->scope.expressions[0]->metadata;
+  if (ret->value == NULL || ret->value->token != AST_TREE_TOKEN_FUNCTION_CALL) {
+    return AST_TREE_TOKEN_NONE;
+  }
+  AstTreeFunctionCall *call = ret->value->metadata;
+  const AstTreeToken builtin = call->function->token;
+  if (builtin < AST_TREE_TOKEN_BUILTIN_NEG ||
+      builtin > AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL ||
+      call->parameters_size != function->arguments.size) {
+    return AST_TREE_TOKEN_NONE;
+  }
+  for (size_t i = 0; i < call->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = call->parameters[i];
+    AstTreeVariable *argument = function->arguments.data[i];
+    if (param.nameBegin != param.nameEnd || argument->isLazy ||
+        argument->isConst || param.value->token != AST_TREE_TOKEN_VARIABLE ||
+        param.value->metadata != argument) {
+      return AST_TREE_TOKEN_NONE;
+    }
+  }
+  return builtin;
+}
+
+static bool isBoolValue(AstTree *tree, bool value) {
+  return tree->token == AST_TREE_TOKEN_VALUE_BOOL &&
+         *(AstTreeBool *)tree->metadata == value;
+}
+
+static AstTree *unwrapScope(AstTree *tree) {
+  while (tree->token == AST_TREE_TOKEN_SCOPE) {
+    AstTreeScope *scope = tree->metadata;
+    if (scope->expressions_size != 1) {
+      break;
+    }
+    tree = scope->expressions[0];
+  }
+  return tree;
+}
+
+static bool isReturnBool(AstTree *tree, bool value) {
+  tree = unwrapScope(tree);
+  if (tree->token != AST_TREE_TOKEN_KEYWORD_RETURN) {
+    return false;
+  }
+  AstTreeReturn *ret = tree->metadata;
+  return ret->value != NULL && isBoolValue(ret->value, value);
+}
+
+// matches `if variable == value { return value; } else ...` and returns the
+// else body or NULL
+static AstTree *getShortCircuitStep(AstTree *tree, AstTreeVariable *variable,
+                                    bool value) {
+  tree = unwrapScope(tree);
+  if (tree->token != AST_TREE_TOKEN_KEYWORD_IF) {
+    return NULL;
+  }
+  AstTreeIf *metadata = tree->metadata;
+  if (metadata->elseBody == NULL ||
+      metadata->condition->token != AST_TREE_TOKEN_OPERATOR_EQUAL ||
+      !isReturnBool(metadata->ifBody, value)) {
+    return NULL;
+  }
+  AstTreeInfix *condition = metadata->condition->metadata;
+  if (condition->left->token != AST_TREE_TOKEN_VARIABLE ||
+      condition->left->metadata != variable ||
+      !isBoolValue(condition->right, value) ||
+      getForwardedBuiltin(condition->function) != AST_TREE_TOKEN_BUILTIN_EQUAL) {
+    return NULL;
+  }
+  return metadata->elseBody;
+}
+
+// whether the function is the stock `__logical_and__` or `__logical_or__`
+// that only evaluates its lazy right argument when left isn't enough
+bool isShortCircuit(AstTreeVariable *variable, bool isAnd) {
+  if (!variable->isConst || variable->value == NULL ||
+      variable->value->token != AST_TREE_TOKEN_FUNCTION) {
+    return false;
+  }
+  AstTreeFunction *function = variable->value->metadata;
+  if (function->arguments.size != 2 || function->scope.expressions_size != 1 ||
+      function->returnType->token != AST_TREE_TOKEN_TYPE_BOOL) {
+    return false;
+  }
+  AstTreeVariable *left = function->arguments.data[0];
+  AstTreeVariable *right = function->arguments.data[1];
+  if (left->isLazy || left->isConst || !right->isLazy || right->isConst ||
+      left->type->token != AST_TREE_TOKEN_TYPE_BOOL ||
+      right->type->token != AST_TREE_TOKEN_TYPE_BOOL) {
+    return false;
+  }
+
+  const bool value = !isAnd;
+  AstTree *tree =
+      getShortCircuitStep(function->scope.expressions[0], left, value);
+  if (tree == NULL) {
+    return false;
+  }
+  tree = getShortCircuitStep(tree, right, value);
+  return tree != NULL && isReturnBool(tree, !value);
+}
+
+// whether running the tree can't call functions, evaluate lazy values or loop
+bool isLeaf(AstTree *tree) {
+  switch (tree->token) {
+  case AST_TREE_TOKEN_FUNCTION:
+  case AST_TREE_TOKEN_BUILTIN_CAST:
+  case AST_TREE_TOKEN_BUILTIN_TYPE_OF:
+  case AST_TREE_TOKEN_BUILTIN_IMPORT:
+  case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
+  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+  case AST_TREE_TOKEN_BUILTIN_NEG:
+  case AST_TREE_TOKEN_BUILTIN_ADD:
+  case AST_TREE_TOKEN_BUILTIN_SUB:
+  case AST_TREE_TOKEN_BUILTIN_MUL:
+  case AST_TREE_TOKEN_BUILTIN_DIV:
+  case AST_TREE_TOKEN_BUILTIN_MOD:
+  case AST_TREE_TOKEN_BUILTIN_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_NOT_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_GREATER:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER:
+  case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
+  case AST_TREE_TOKEN_KEYWORD_STRUCT:
+  case AST_TREE_TOKEN_TYPE_FUNCTION:
+  case AST_TREE_TOKEN_TYPE_TYPE:
+  case AST_TREE_TOKEN_TYPE_VOID:
+  case AST_TREE_TOKEN_TYPE_I8:
+  case AST_TREE_TOKEN_TYPE_U8:
+  case AST_TREE_TOKEN_TYPE_I16:
+  case AST_TREE_TOKEN_TYPE_U16:
+  case AST_TREE_TOKEN_TYPE_I32:
+  case AST_TREE_TOKEN_TYPE_U32:
+  case AST_TREE_TOKEN_TYPE_I64:
+  case AST_TREE_TOKEN_TYPE_U64:
+#ifdef FLOAT_16_SUPPORT
+  case AST_TREE_TOKEN_TYPE_F16:
+#endif
+  case AST_TREE_TOKEN_TYPE_F32:
+  case AST_TREE_TOKEN_TYPE_F64:
+  case AST_TREE_TOKEN_TYPE_F128:
+  case AST_TREE_TOKEN_TYPE_CODE:
+  case AST_TREE_TOKEN_TYPE_NAMESPACE:
+  case AST_TREE_TOKEN_TYPE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_TYPE_BOOL:
+  case AST_TREE_TOKEN_VALUE_VOID:
+  case AST_TREE_TOKEN_VALUE_NULL:
+  case AST_TREE_TOKEN_VALUE_UNDEFINED:
+  case AST_TREE_TOKEN_VALUE_NAMESPACE:
+  case AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_VALUE_INT:
+  case AST_TREE_TOKEN_VALUE_FLOAT:
+  case AST_TREE_TOKEN_VALUE_BOOL:
+  case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT:
+  case AST_TREE_TOKEN_KEYWORD_BREAK:
+  case AST_TREE_TOKEN_KEYWORD_CONTINUE:
+    return true;
+  case AST_TREE_TOKEN_VARIABLE: {
+    AstTreeVariable *metadata = tree->metadata;
+    return !metadata->isLazy;
+  }
+  case AST_TREE_TOKEN_VARIABLE_DEFINE: {
+    AstTreeVariable *metadata = tree->metadata;
+    return !metadata->isLazy &&
+           (metadata->initValue == NULL || isLeaf(metadata->initValue));
+  }
+  case AST_TREE_TOKEN_OPERATOR_ASSIGN:
+  case AST_TREE_TOKEN_OPERATOR_SUM:
+  case AST_TREE_TOKEN_OPERATOR_SUB:
+  case AST_TREE_TOKEN_OPERATOR_MULTIPLY:
+  case AST_TREE_TOKEN_OPERATOR_DIVIDE:
+  case AST_TREE_TOKEN_OPERATOR_MODULO:
+  case AST_TREE_TOKEN_OPERATOR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_NOT_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_GREATER:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER:
+  case AST_TREE_TOKEN_OPERATOR_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_AND:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_OR: {
+    AstTreeInfix *metadata = tree->metadata;
+    return (metadata->function == NULL ||
+            metadata->builtin != AST_TREE_TOKEN_NONE) &&
+           isLeaf(metadata->left) && isLeaf(metadata->right);
+  }
+  case AST_TREE_TOKEN_OPERATOR_PLUS:
+  case AST_TREE_TOKEN_OPERATOR_MINUS:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_NOT: {
+    AstTreeUnary *metadata = tree->metadata;
+    return (metadata->function == NULL ||
+            metadata->builtin != AST_TREE_TOKEN_NONE) &&
+           isLeaf(metadata->operand);
+  }
+  case AST_TREE_TOKEN_OPERATOR_POINTER:
+  case AST_TREE_TOKEN_OPERATOR_ADDRESS:
+  case AST_TREE_TOKEN_OPERATOR_DEREFERENCE:
+  case AST_TREE_TOKEN_KEYWORD_PUTC: {
+    AstTreeSingleChild *metadata = tree->metadata;
+    return isLeaf(metadata);
+  }
+  case AST_TREE_TOKEN_OPERATOR_ACCESS: {
+    AstTreeAccess *metadata = tree->metadata;
+    return isLeaf(metadata->object);
+  }
+  case AST_TREE_TOKEN_OPERATOR_ARRAY_ACCESS: {
+    AstTreeBracket *metadata = tree->metadata;
+    for (size_t i = 0; i < metadata->parameters.size; ++i) {
+      if (!isLeaf(metadata->parameters.data[i])) {
+        return false;
+      }
+    }
+    return isLeaf(metadata->operand);
+  }
+  case AST_TREE_TOKEN_KEYWORD_RETURN: {
+    AstTreeReturn *metadata = tree->metadata;
+    return metadata->value == NULL || isLeaf(metadata->value);
+  }
+  case AST_TREE_TOKEN_KEYWORD_IF: {
+    AstTreeIf *metadata = tree->metadata;
+    return isLeaf(metadata->condition) && isLeaf(metadata->ifBody) &&
+           (metadata->elseBody == NULL || isLeaf(metadata->elseBody));
+  }
+  case AST_TREE_TOKEN_SCOPE: {
+    AstTreeScope *metadata = tree->metadata;
+    for (size_t i = 0; i < metadata->expressions_size; ++i) {
+      if (!isLeaf(metadata->expressions[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+  case AST_TREE_TOKEN_FUNCTION_CALL:
+  case AST_TREE_TOKEN_KEYWORD_WHILE:
+  case AST_TREE_TOKEN_KEYWORD_COMPTIME:
+  case AST_TREE_TOKEN_TYPE_ARRAY:
+  case AST_TREE_TOKEN_THUNK:
+    return false;
+  case AST_TREE_TOKEN_NONE:
+  }
+  UNREACHABLE;
+}
+
 bool isConst(AstTree *tree) {
   if (tree->type == NULL) {
     UNREACHABLE;
@@ -3334,6 +3962,26 @@ bool isConst(AstTree *tree) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -3375,6 +4023,8 @@ bool isConst(AstTree *tree) {
   case AST_TREE_TOKEN_VALUE_FLOAT:
   case AST_TREE_TOKEN_VALUE_BOOL:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
   case AST_TREE_TOKEN_KEYWORD_COMPTIME:
   case AST_TREE_TOKEN_SCOPE:
     return true;
@@ -3420,6 +4070,7 @@ bool isConst(AstTree *tree) {
   case AST_TREE_TOKEN_KEYWORD_CONTINUE:
   case AST_TREE_TOKEN_VARIABLE_DEFINE:
   case AST_TREE_TOKEN_OPERATOR_ASSIGN:
+  case AST_TREE_TOKEN_THUNK:
     return false;
   case AST_TREE_TOKEN_OPERATOR_PLUS:
   case AST_TREE_TOKEN_OPERATOR_MINUS:
@@ -3633,6 +4284,26 @@ AstTree *makeTypeOf(AstTree *value) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -3646,6 +4317,9 @@ AstTree *makeTypeOf(AstTree *value) {
   case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
   case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
   case AST_TREE_TOKEN_VARIABLE_DEFINE:
   case AST_TREE_TOKEN_KEYWORD_PUTC:
   case AST_TREE_TOKEN_KEYWORD_RETURN:
@@ -3712,6 +4386,26 @@ bool typeIsEqualBack(const AstTree *type0, const AstTree *type1) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -3741,6 +4435,9 @@ bool typeIsEqualBack(const AstTree *type0, const AstTree *type1) {
   case AST_TREE_TOKEN_VALUE_FLOAT:
   case AST_TREE_TOKEN_VALUE_BOOL:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
   case AST_TREE_TOKEN_VARIABLE_DEFINE:
   case AST_TREE_TOKEN_OPERATOR_ASSIGN:
   case AST_TREE_TOKEN_OPERATOR_SUM:
@@ -3867,23 +4564,85 @@ bool typeIsEqualBack(const AstTree *type0, const AstTree *type1) {
   UNREACHABLE;
 }
 
-AstTree *getValue(AstTree *tree, bool copy) {
-  if (!isConst(tree)) {
-    printError(tree->str_begin, tree->str_end,
-               "Can't get value at compile time because it is not const");
-    return NULL;
+AstTree *getConstValue(AstTree *tree) {
+  if (!astTreeShouldDelete(tree) ||
+      tree->token == AST_TREE_TOKEN_KEYWORD_STRUCT ||
+      tree->token == AST_TREE_TOKEN_FUNCTION ||
+      tree->token == AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER) {
+    // these are their own value
+    return tree;
+  } else if (tree->constValue != NULL) {
+    return tree->constValue;
   }
-  switch (tree->token) {
-  case AST_TREE_TOKEN_BUILTIN_CAST:
-  case AST_TREE_TOKEN_BUILTIN_TYPE_OF:
-  case AST_TREE_TOKEN_BUILTIN_IMPORT:
-  case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
-  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
-  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
-  case AST_TREE_TOKEN_BUILTIN_NEG:
-  case AST_TREE_TOKEN_BUILTIN_ADD:
-  case AST_TREE_TOKEN_BUILTIN_SUB:
-  case AST_TREE_TOKEN_BUILTIN_MUL:
+
+  bool shouldRet = false;
+  u32 breakCount = 0;
+  bool shouldContinue = false;
+  AstTreeScope *scope = a404m_malloc(sizeof(*scope));
+  scope->expressions = a404m_malloc(0);
+  scope->expressions_size = 0;
+  scope->variables.data = a404m_malloc(0);
+  scope->variables.size = 0;
+
+  AstTree scopeTree = {
+      .token = AST_TREE_TOKEN_SCOPE,
+      .metadata = scope,
+      .type = &AST_TREE_VOID_TYPE,
+      .str_begin = NULL,
+      .str_end = NULL,
+      .constValue = NULL,
+  };
+
+  AstTree *value = runExpression(tree, scope, &shouldRet, false, true,
+                                 &breakCount, &shouldContinue);
+
+  astTreeDestroy(scopeTree);
+
+  if (value == NULL) {
+    printError(tree->str_begin, tree->str_end, "Unknown error");
+  } else {
+    tree->constValue = value;
+  }
+  return value;
+}
+
+AstTree *getValue(AstTree *tree, bool copy) {
+  if (!isConst(tree)) {
+    printError(tree->str_begin, tree->str_end,
+               "Can't get value at compile time because it is not const");
+    return NULL;
+  }
+  switch (tree->token) {
+  case AST_TREE_TOKEN_BUILTIN_CAST:
+  case AST_TREE_TOKEN_BUILTIN_TYPE_OF:
+  case AST_TREE_TOKEN_BUILTIN_IMPORT:
+  case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
+  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+  case AST_TREE_TOKEN_BUILTIN_NEG:
+  case AST_TREE_TOKEN_BUILTIN_ADD:
+  case AST_TREE_TOKEN_BUILTIN_SUB:
+  case AST_TREE_TOKEN_BUILTIN_MUL:
   case AST_TREE_TOKEN_BUILTIN_DIV:
   case AST_TREE_TOKEN_BUILTIN_MOD:
   case AST_TREE_TOKEN_BUILTIN_EQUAL:
@@ -3921,6 +4680,9 @@ AstTree *getValue(AstTree *tree, bool copy) {
   case AST_TREE_TOKEN_VALUE_FLOAT:
   case AST_TREE_TOKEN_VALUE_BOOL:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
   case AST_TREE_TOKEN_VARIABLE:
   case AST_TREE_TOKEN_FUNCTION_CALL:
   case AST_TREE_TOKEN_OPERATOR_ASSIGN:
@@ -3951,36 +4713,16 @@ AstTree *getValue(AstTree *tree, bool copy) {
   case AST_TREE_TOKEN_TYPE_ARRAY:
   case AST_TREE_TOKEN_OPERATOR_ARRAY_ACCESS:
   case AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT: {
-    bool shouldRet = false;
-    u32 breakCount = 0;
-    bool shouldContinue = false;
-    AstTreeScope *scope = a404m_malloc(sizeof(*scope));
-    scope->expressions = a404m_malloc(0);
-    scope->expressions_size = 0;
-    scope->variables.data = a404m_malloc(0);
-    scope->variables.size = 0;
-
-    AstTree scopeTree = {
-        .token = AST_TREE_TOKEN_SCOPE,
-        .metadata = scope,
-        .type = &AST_TREE_VOID_TYPE,
-        .str_begin = NULL,
-        .str_end = NULL,
-    };
-
-    AstTree *value = runExpression(tree, scope, &shouldRet, false, true,
-                                   &breakCount, &shouldContinue);
-
-    if (!copy) {
-      astTreeDelete(tree);
-    }
-
-    astTreeDestroy(scopeTree);
-
+    AstTree *value = getConstValue(tree);
     if (value == NULL) {
-      printError(tree->str_begin, tree->str_end, "Unknown error");
+      return NULL;
+    } else if (copy || !astTreeShouldDelete(tree)) {
+      return copyAstTree(value);
+    } else {
+      tree->constValue = NULL;
+      astTreeDelete(tree);
+      return value;
     }
-    return value;
   }
   case AST_TREE_TOKEN_KEYWORD_STRUCT:
   case AST_TREE_TOKEN_FUNCTION:
@@ -4019,6 +4761,26 @@ bool isIntType(AstTree *type) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -4065,6 +4827,9 @@ bool isIntType(AstTree *type) {
   case AST_TREE_TOKEN_VALUE_FLOAT:
   case AST_TREE_TOKEN_VALUE_BOOL:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
   case AST_TREE_TOKEN_OPERATOR_ASSIGN:
   case AST_TREE_TOKEN_OPERATOR_PLUS:
   case AST_TREE_TOKEN_OPERATOR_MINUS:
@@ -4148,6 +4913,26 @@ bool isEqual(AstTree *left, AstTree *right) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -4176,6 +4961,9 @@ bool isEqual(AstTree *left, AstTree *right) {
   case AST_TREE_TOKEN_VALUE_FLOAT:
   case AST_TREE_TOKEN_VALUE_BOOL:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
   case AST_TREE_TOKEN_OPERATOR_ASSIGN:
   case AST_TREE_TOKEN_OPERATOR_PLUS:
   case AST_TREE_TOKEN_OPERATOR_MINUS:
@@ -4399,6 +5187,9 @@ bool setAllTypes(AstTree *tree, AstTreeSetTypesHelper helper,
   case AST_TREE_TOKEN_VALUE_UNDEFINED:
     return setTypesValueUndefined(tree, helper);
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
     return setTypesValueObject(tree, helper);
   case AST_TREE_TOKEN_FUNCTION:
     return setTypesFunction(tree, helper);
@@ -4485,9 +5276,40 @@ bool setAllTypes(AstTree *tree, AstTreeSetTypesHelper helper,
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
     return setTypesBuiltinIsComptime(tree, helper);
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
-    return setTypesBuiltinStackAlloc(tree, helper, functionCall);
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
-    return setTypesBuiltinHeapAlloc(tree, helper, functionCall);
+    return setTypesBuiltinAlloc(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+    return setTypesBuiltinFree(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+    return setTypesBuiltinFfi(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+    return setTypesBuiltinSpawn(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+    return setTypesBuiltinJoin(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    return setTypesBuiltinAtomic(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+    return setTypesBuiltinParallelFor(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+    return setTypesBuiltinGetc(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_READ:
+    return setTypesBuiltinRead(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+    return setTypesBuiltinMapFile(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+    return setTypesBuiltinUnmapFile(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+    return setTypesBuiltinMemory(tree, helper, functionCall);
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+    return setTypesBuiltinReduce(tree, helper, functionCall);
   case AST_TREE_TOKEN_BUILTIN_NEG:
     return setTypesBuiltinUnary(tree, helper, functionCall);
   case AST_TREE_TOKEN_BUILTIN_ADD:
@@ -4581,46 +5403,46 @@ bool setTypesValueInt(AstTree *tree, AstTreeSetTypesHelper helper) {
     tree->token = AST_TREE_TOKEN_VALUE_FLOAT;
     AstTreeInt *value = tree->metadata;
     f16 newValue = *value;
-    tree->metadata = a404m_malloc(sizeof(f128));
+    tree->metadata = a404m_slab_malloc(sizeof(AstTreeFloat));
     *(AstTreeFloat *)tree->metadata = *value;
     if (*value - newValue != 0) {
       printWarning(tree->str_begin, tree->str_end, "Value is overflowing");
     }
-    free(value);
+    a404m_slab_free(value, sizeof(*value));
     tree->type = &AST_TREE_F16_TYPE;
 #endif
   } else if (typeIsEqual(helper.lookingType, &AST_TREE_F32_TYPE)) {
     tree->token = AST_TREE_TOKEN_VALUE_FLOAT;
     AstTreeInt *value = tree->metadata;
     f32 newValue = *value;
-    tree->metadata = a404m_malloc(sizeof(f128));
+    tree->metadata = a404m_slab_malloc(sizeof(AstTreeFloat));
     *(AstTreeFloat *)tree->metadata = *value;
     if (*value - newValue != 0) {
       printWarning(tree->str_begin, tree->str_end, "Value is overflowing");
     }
-    free(value);
+    a404m_slab_free(value, sizeof(*value));
     tree->type = &AST_TREE_F32_TYPE;
   } else if (typeIsEqual(helper.lookingType, &AST_TREE_F64_TYPE)) {
     tree->token = AST_TREE_TOKEN_VALUE_FLOAT;
     AstTreeInt *value = tree->metadata;
     f64 newValue = *value;
-    tree->metadata = a404m_malloc(sizeof(f128));
+    tree->metadata = a404m_slab_malloc(sizeof(AstTreeFloat));
     *(AstTreeFloat *)tree->metadata = *value;
     if (*value - newValue != 0) {
       printWarning(tree->str_begin, tree->str_end, "Value is overflowing");
     }
-    free(value);
+    a404m_slab_free(value, sizeof(*value));
     tree->type = &AST_TREE_F64_TYPE;
   } else if (typeIsEqual(helper.lookingType, &AST_TREE_F128_TYPE)) {
     tree->token = AST_TREE_TOKEN_VALUE_FLOAT;
     AstTreeInt *value = tree->metadata;
     f128 newValue = *value;
-    tree->metadata = a404m_malloc(sizeof(f128));
+    tree->metadata = a404m_slab_malloc(sizeof(AstTreeFloat));
     *(AstTreeFloat *)tree->metadata = *value;
     if (*value - newValue != 0) {
       printWarning(tree->str_begin, tree->str_end, "Value is overflowing");
     }
-    free(value);
+    a404m_slab_free(value, sizeof(*value));
     tree->type = &AST_TREE_F128_TYPE;
   } else {
     UNREACHABLE;
@@ -4746,11 +5568,14 @@ bool setTypesFunction(AstTree *tree, AstTreeSetTypesHelper _helper) {
   AstTreeVariable *deps[helper.dependencies.size];
   size_t deps_size = 0;
 
+  metadata->slots_size = 0;
+
   for (size_t i = 0; i < metadata->arguments.size; ++i) {
     AstTreeVariable *variable = metadata->arguments.data[i];
     if (!setTypesAstVariable(variable, helper)) {
       return false;
     }
+    variable->slot = metadata->slots_size++;
     helper.variables.data[helper.variables.size++] = variable;
   }
 
@@ -4789,6 +5614,7 @@ bool setTypesFunction(AstTree *tree, AstTreeSetTypesHelper _helper) {
       if (!setTypesAstVariable(variable, helper)) {
         return false;
       }
+      variable->slot = metadata->slots_size++;
       helper.variables.data[helper.variables.size++] = variable;
     }
     if (!setAllTypes(expr, helper, metadata, NULL)) {
@@ -4796,6 +5622,14 @@ bool setTypesFunction(AstTree *tree, AstTreeSetTypesHelper _helper) {
     }
   }
 
+  metadata->isLeaf = true;
+  for (size_t i = 0; i < metadata->scope.expressions_size; ++i) {
+    if (!isLeaf(metadata->scope.expressions[i])) {
+      metadata->isLeaf = false;
+      break;
+    }
+  }
+
   return true;
 }
 
@@ -5092,9 +5926,9 @@ bool setTypesFunctionCall(AstTree *tree, AstTreeSetTypesHelper _helper) {
 
         AstTreeFunctionCallParam p0 = metadata->parameters[i];
         AstTreeFunctionCallParam p1 = call->parameters[i];
-        AstTree *v0 = getValue(p0.value, false);
-        AstTree *v1 = getValue(p1.value, false);
-        if (!isEqual(v0, v1)) {
+        AstTree *v0 = getConstValue(p0.value);
+        AstTree *v1 = getConstValue(p1.value);
+        if (v0 == NULL || v1 == NULL || !isEqual(v0, v1)) {
           goto SEARCH_LOOP_CONTINUE;
         }
       }
@@ -5258,6 +6092,13 @@ bool setTypesOperatorInfix(AstTree *tree, AstTreeSetTypesHelper _helper,
   }
 
   metadata->function = variable;
+  metadata->builtin = getForwardedBuiltin(variable);
+  if ((tree->token == AST_TREE_TOKEN_OPERATOR_LOGICAL_AND ||
+       tree->token == AST_TREE_TOKEN_OPERATOR_LOGICAL_OR) &&
+      isShortCircuit(variable,
+                     tree->token == AST_TREE_TOKEN_OPERATOR_LOGICAL_AND)) {
+    metadata->builtin = tree->token;
+  }
   AstTreeTypeFunction *function = metadata->function->type->metadata;
 
   tree->type = copyAstTree(function->returnType);
@@ -5321,6 +6162,7 @@ bool setTypesOperatorUnary(AstTree *tree, AstTreeSetTypesHelper helper,
   }
 
   metadata->function = variable;
+  metadata->builtin = getForwardedBuiltin(variable);
   AstTreeTypeFunction *function = metadata->function->type->metadata;
 
   tree->type = copyAstTree(function->returnType);
@@ -5512,7 +6354,7 @@ bool setTypesIf(AstTree *tree, AstTreeSetTypesHelper helper,
     astTreeDestroy(*tree);
     *tree = *result;
     if (astTreeShouldDelete(result)) {
-      free(result);
+      a404m_slab_free(result, sizeof(*result));
     }
   } else {
     if (!setAllTypes(metadata->ifBody, helper, function, NULL) ||
@@ -5616,6 +6458,9 @@ bool setTypesScope(AstTree *tree, AstTreeSetTypesHelper _helper,
       if (!setTypesAstVariable(variable, helper)) {
         return false;
       }
+      if (function != NULL) {
+        variable->slot = function->slots_size++;
+      }
       helper.variables.data[helper.variables.size++] = variable;
     }
     if (!setAllTypes(expr, helper, function, NULL)) {
@@ -5659,6 +6504,7 @@ bool setTypesStruct(AstTree *tree, AstTreeSetTypesHelper helper) {
       return false;
     }
   }
+  setStructLayout(metadata);
   tree->type = &AST_TREE_TYPE_TYPE;
   return true;
 }
@@ -5952,185 +6798,1131 @@ bool setTypesBuiltinIsComptime(AstTree *tree, AstTreeSetTypesHelper helper) {
   return true;
 }
 
-bool setTypesBuiltinStackAlloc(AstTree *tree, AstTreeSetTypesHelper helper,
-                               AstTreeFunctionCall *functionCall) {
-  (void)tree;
-  (void)helper;
-  (void)functionCall;
-  NOT_IMPLEMENTED;
-}
-
-bool setTypesBuiltinHeapAlloc(AstTree *tree, AstTreeSetTypesHelper helper,
-                              AstTreeFunctionCall *functionCall) {
-  (void)tree;
-  (void)helper;
-  (void)functionCall;
-  NOT_IMPLEMENTED;
-}
-
-bool setTypesBuiltinUnary(AstTree *tree, AstTreeSetTypesHelper helper,
+bool setTypesBuiltinAlloc(AstTree *tree, AstTreeSetTypesHelper helper,
                           AstTreeFunctionCall *functionCall) {
   (void)helper;
-  if (functionCall->parameters_size != 1) {
-    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
-    return false;
-  }
+  if (functionCall->parameters_size == 2) {
+    AstTree *type = NULL;
+    AstTree *count = NULL;
 
-  const char *str = functionCall->parameters[0].nameBegin;
-  const size_t str_size = functionCall->parameters[0].nameEnd -
-                          functionCall->parameters[0].nameBegin;
+    static const char TYPE_STR[] = "type";
+    static const size_t TYPE_STR_SIZE =
+        sizeof(TYPE_STR) / sizeof(*TYPE_STR) - sizeof(*TYPE_STR);
+    static const char COUNT_STR[] = "count";
+    static const size_t COUNT_STR_SIZE =
+        sizeof(COUNT_STR) / sizeof(*COUNT_STR) - sizeof(*COUNT_STR);
 
-  static char VALUE_STR[] = "value";
-  static size_t VALUE_STR_SIZE =
-      sizeof(VALUE_STR) / sizeof(*VALUE_STR) - sizeof(*VALUE_STR);
+    for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+      AstTreeFunctionCallParam param = functionCall->parameters[i];
+      const size_t param_name_size = param.nameEnd - param.nameBegin;
 
-  if (str_size != 0 && (str_size != VALUE_STR_SIZE ||
-                        !strnEquals(str, VALUE_STR, VALUE_STR_SIZE))) {
-    printError(functionCall->parameters[0].nameBegin,
-               functionCall->parameters[0].nameEnd, "Unknown parameter");
-    return false;
-  }
+      if (param_name_size == 0) {
+        if (type == NULL) {
+          type = param.value;
+        } else if (count == NULL) {
+          count = param.value;
+        } else {
+          printError(param.value->str_begin, param.value->str_end,
+                     "Bad paramter");
+          return false;
+        }
+      } else if (param_name_size == TYPE_STR_SIZE &&
+                 strnEquals(param.nameBegin, TYPE_STR, TYPE_STR_SIZE) &&
+                 type == NULL) {
+        type = param.value;
+      } else if (param_name_size == COUNT_STR_SIZE &&
+                 strnEquals(param.nameBegin, COUNT_STR, COUNT_STR_SIZE) &&
+                 count == NULL) {
+        count = param.value;
+      } else {
+        printError(param.value->str_begin, param.value->str_end,
+                   "Bad paramter");
+        return false;
+      }
+    }
 
-  AstTree *type = functionCall->parameters[0].value->type;
-  switch (type->token) {
-  case AST_TREE_TOKEN_TYPE_I8:
-  case AST_TREE_TOKEN_TYPE_U8:
-  case AST_TREE_TOKEN_TYPE_I16:
-  case AST_TREE_TOKEN_TYPE_U16:
-  case AST_TREE_TOKEN_TYPE_I32:
-  case AST_TREE_TOKEN_TYPE_U32:
-  case AST_TREE_TOKEN_TYPE_I64:
-  case AST_TREE_TOKEN_TYPE_U64:
-  case AST_TREE_TOKEN_TYPE_F16:
-  case AST_TREE_TOKEN_TYPE_F32:
-  case AST_TREE_TOKEN_TYPE_F64:
-  case AST_TREE_TOKEN_TYPE_F128:
-    goto AFTER_SWITCH;
-  case AST_TREE_TOKEN_FUNCTION:
-  case AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER:
-  case AST_TREE_TOKEN_BUILTIN_CAST:
-  case AST_TREE_TOKEN_BUILTIN_TYPE_OF:
-  case AST_TREE_TOKEN_BUILTIN_IMPORT:
-  case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
-  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
-  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
-  case AST_TREE_TOKEN_BUILTIN_NEG:
-  case AST_TREE_TOKEN_BUILTIN_ADD:
-  case AST_TREE_TOKEN_BUILTIN_SUB:
-  case AST_TREE_TOKEN_BUILTIN_MUL:
-  case AST_TREE_TOKEN_BUILTIN_DIV:
-  case AST_TREE_TOKEN_BUILTIN_MOD:
-  case AST_TREE_TOKEN_BUILTIN_EQUAL:
-  case AST_TREE_TOKEN_BUILTIN_NOT_EQUAL:
-  case AST_TREE_TOKEN_BUILTIN_GREATER:
-  case AST_TREE_TOKEN_BUILTIN_SMALLER:
-  case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
-  case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
-  case AST_TREE_TOKEN_KEYWORD_PUTC:
-  case AST_TREE_TOKEN_KEYWORD_RETURN:
-  case AST_TREE_TOKEN_KEYWORD_BREAK:
-  case AST_TREE_TOKEN_KEYWORD_CONTINUE:
-  case AST_TREE_TOKEN_KEYWORD_IF:
-  case AST_TREE_TOKEN_KEYWORD_WHILE:
-  case AST_TREE_TOKEN_KEYWORD_COMPTIME:
-  case AST_TREE_TOKEN_KEYWORD_STRUCT:
-  case AST_TREE_TOKEN_TYPE_FUNCTION:
-  case AST_TREE_TOKEN_TYPE_ARRAY:
-  case AST_TREE_TOKEN_TYPE_TYPE:
-  case AST_TREE_TOKEN_TYPE_VOID:
-  case AST_TREE_TOKEN_TYPE_CODE:
-  case AST_TREE_TOKEN_TYPE_NAMESPACE:
-  case AST_TREE_TOKEN_TYPE_SHAPE_SHIFTER:
-  case AST_TREE_TOKEN_TYPE_BOOL:
-  case AST_TREE_TOKEN_VALUE_VOID:
-  case AST_TREE_TOKEN_VALUE_NAMESPACE:
-  case AST_TREE_TOKEN_FUNCTION_CALL:
-  case AST_TREE_TOKEN_VARIABLE:
-  case AST_TREE_TOKEN_VARIABLE_DEFINE:
-  case AST_TREE_TOKEN_VALUE_NULL:
-  case AST_TREE_TOKEN_VALUE_UNDEFINED:
-  case AST_TREE_TOKEN_VALUE_INT:
-  case AST_TREE_TOKEN_VALUE_FLOAT:
-  case AST_TREE_TOKEN_VALUE_BOOL:
-  case AST_TREE_TOKEN_VALUE_OBJECT:
-  case AST_TREE_TOKEN_OPERATOR_ASSIGN:
-  case AST_TREE_TOKEN_OPERATOR_PLUS:
-  case AST_TREE_TOKEN_OPERATOR_MINUS:
-  case AST_TREE_TOKEN_OPERATOR_SUM:
-  case AST_TREE_TOKEN_OPERATOR_SUB:
-  case AST_TREE_TOKEN_OPERATOR_MULTIPLY:
-  case AST_TREE_TOKEN_OPERATOR_DIVIDE:
-  case AST_TREE_TOKEN_OPERATOR_MODULO:
-  case AST_TREE_TOKEN_OPERATOR_EQUAL:
-  case AST_TREE_TOKEN_OPERATOR_NOT_EQUAL:
-  case AST_TREE_TOKEN_OPERATOR_GREATER:
-  case AST_TREE_TOKEN_OPERATOR_SMALLER:
-  case AST_TREE_TOKEN_OPERATOR_GREATER_OR_EQUAL:
-  case AST_TREE_TOKEN_OPERATOR_SMALLER_OR_EQUAL:
-  case AST_TREE_TOKEN_OPERATOR_POINTER:
-  case AST_TREE_TOKEN_OPERATOR_ADDRESS:
-  case AST_TREE_TOKEN_OPERATOR_DEREFERENCE:
-  case AST_TREE_TOKEN_OPERATOR_ACCESS:
-  case AST_TREE_TOKEN_OPERATOR_LOGICAL_NOT:
-  case AST_TREE_TOKEN_OPERATOR_LOGICAL_AND:
-  case AST_TREE_TOKEN_OPERATOR_LOGICAL_OR:
-  case AST_TREE_TOKEN_OPERATOR_ARRAY_ACCESS:
-  case AST_TREE_TOKEN_SCOPE:
-  case AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT:
-  case AST_TREE_TOKEN_NONE:
-  }
-  printError(functionCall->parameters[0].nameBegin,
-             functionCall->parameters[0].nameEnd, "Bad argument");
-  return false;
+    if (type == NULL || count == NULL) {
+      return false;
+    } else if (!typeIsEqual(type->type, &AST_TREE_TYPE_TYPE)) {
+      printError(type->str_begin, type->str_end, "Expected type");
+      return false;
+    } else if (!isConst(type)) {
+      printError(type->str_begin, type->str_end, "Type must be constant");
+      return false;
+    } else if (!isIntType(count->type)) {
+      printError(count->str_begin, count->str_end, "Expected int");
+      return false;
+    }
 
-AFTER_SWITCH:
-  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
-  type_metadata->arguments_size = 1;
-  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
-                                          sizeof(*type_metadata->arguments));
+    AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+    type_metadata->arguments_size = 2;
+    type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                            sizeof(*type_metadata->arguments));
 
-  type_metadata->returnType = copyAstTree(type);
+    // a slice of the elements, it is valid until the caller returns for
+    // @stackAlloc and until it is given to @free for @heapAlloc
+    AstTreeBracket *slice_metadata = a404m_malloc(sizeof(*slice_metadata));
+    slice_metadata->operand = copyAstTree(type);
+    slice_metadata->parameters.data = NULL;
+    slice_metadata->parameters.size = 0;
+    type_metadata->returnType =
+        newAstTree(AST_TREE_TOKEN_TYPE_ARRAY, slice_metadata,
+                   &AST_TREE_TYPE_TYPE, NULL, NULL);
 
-  type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
-      .type = copyAstTree(type),
-      .name_begin = VALUE_STR,
-      .name_end = VALUE_STR + VALUE_STR_SIZE,
-      .str_begin = NULL,
-      .str_end = NULL,
-      .isComptime = false,
-  };
+    type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(type->type),
+        .name_begin = TYPE_STR,
+        .name_end = TYPE_STR + TYPE_STR_SIZE,
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
 
-  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
-                          &AST_TREE_TYPE_TYPE, NULL, NULL);
-  return true;
-}
+    type_metadata->arguments[1] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(count->type),
+        .name_begin = COUNT_STR,
+        .name_end = COUNT_STR + COUNT_STR_SIZE,
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
 
-bool setTypesBuiltinBinary(AstTree *tree, AstTreeSetTypesHelper helper,
-                           AstTreeFunctionCall *functionCall) {
-  (void)helper;
-  if (functionCall->parameters_size != 2) {
+    tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                            &AST_TREE_TYPE_TYPE, NULL, NULL);
+    return true;
+  } else {
     printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
     return false;
   }
-  AstTree *left = NULL;
-  AstTree *right = NULL;
+}
 
-  static char LEFT_STR[] = "left";
-  static const size_t LEFT_STR_SIZE =
-      sizeof(LEFT_STR) / sizeof(*LEFT_STR) - sizeof(*LEFT_STR);
-  static char RIGHT_STR[] = "right";
-  static const size_t RIGHT_STR_SIZE =
-      sizeof(RIGHT_STR) / sizeof(*RIGHT_STR) - sizeof(*RIGHT_STR);
+bool setTypesBuiltinFree(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size == 1) {
+    AstTree *slice = NULL;
 
-  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
-    AstTreeFunctionCallParam param = functionCall->parameters[i];
-    const size_t param_name_size = param.nameEnd - param.nameBegin;
+    static const char SLICE_STR[] = "slice";
+    static const size_t SLICE_STR_SIZE =
+        sizeof(SLICE_STR) / sizeof(*SLICE_STR) - sizeof(*SLICE_STR);
 
-    if (param_name_size == 0) {
-      if (left == NULL) {
-        left = param.value;
-      } else if (right == NULL) {
-        right = param.value;
+    for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+      AstTreeFunctionCallParam param = functionCall->parameters[i];
+      const size_t param_name_size = param.nameEnd - param.nameBegin;
+
+      if (param_name_size == 0) {
+        if (slice == NULL) {
+          slice = param.value;
+        } else {
+          printError(param.value->str_begin, param.value->str_end,
+                     "Bad paramter");
+          return false;
+        }
+      } else if (param_name_size == SLICE_STR_SIZE &&
+                 strnEquals(param.nameBegin, SLICE_STR, SLICE_STR_SIZE) &&
+                 slice == NULL) {
+        slice = param.value;
+      } else {
+        printError(param.value->str_begin, param.value->str_end,
+                   "Bad paramter");
+        return false;
+      }
+    }
+
+    if (slice == NULL) {
+      return false;
+    } else if (slice->type->token != AST_TREE_TOKEN_TYPE_ARRAY ||
+               ((AstTreeBracket *)slice->type->metadata)->parameters.size !=
+                   0) {
+      printError(slice->str_begin, slice->str_end, "Expected slice");
+      return false;
+    }
+
+    AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+    type_metadata->arguments_size = 1;
+    type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                            sizeof(*type_metadata->arguments));
+
+    type_metadata->returnType = copyAstTree(&AST_TREE_VOID_TYPE);
+
+    type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(slice->type),
+        .name_begin = SLICE_STR,
+        .name_end = SLICE_STR + SLICE_STR_SIZE,
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+
+    tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                            &AST_TREE_TYPE_TYPE, NULL, NULL);
+    return true;
+  } else {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+}
+
+static bool isU8Array(AstTree *type) {
+  return type->token == AST_TREE_TOKEN_TYPE_ARRAY &&
+         typeIsEqual(((AstTreeBracket *)type->metadata)->operand,
+                     &AST_TREE_U8_TYPE);
+}
+
+bool setTypesBuiltinFfi(AstTree *tree, AstTreeSetTypesHelper helper,
+                        AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size < 3) {
+    printError(tree->str_begin, tree->str_end, "Too few arguments");
+    return false;
+  }
+
+  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = functionCall->parameters[i];
+    if (param.nameBegin != param.nameEnd) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Bad paramter");
+      return false;
+    } else if (i < 2 && !isU8Array(param.value->type)) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Expected string");
+      return false;
+    }
+  }
+
+  AstTree *returnType = functionCall->parameters[2].value;
+  if (!typeIsEqual(returnType->type, &AST_TREE_TYPE_TYPE)) {
+    printError(returnType->str_begin, returnType->str_end, "Expected type");
+    return false;
+  } else if (!isConst(returnType)) {
+    printError(returnType->str_begin, returnType->str_end,
+               "Type must be constant");
+    return false;
+  }
+
+  static const char LIBRARY_STR[] = "library";
+  static const size_t LIBRARY_STR_SIZE =
+      sizeof(LIBRARY_STR) / sizeof(*LIBRARY_STR) - sizeof(*LIBRARY_STR);
+  static const char NAME_STR[] = "name";
+  static const size_t NAME_STR_SIZE =
+      sizeof(NAME_STR) / sizeof(*NAME_STR) - sizeof(*NAME_STR);
+  static const char RETURN_STR[] = "returnType";
+  static const size_t RETURN_STR_SIZE =
+      sizeof(RETURN_STR) / sizeof(*RETURN_STR) - sizeof(*RETURN_STR);
+  static const char *NAMES[] = {LIBRARY_STR, NAME_STR, RETURN_STR};
+  static const size_t NAME_SIZES[] = {LIBRARY_STR_SIZE, NAME_STR_SIZE,
+                                      RETURN_STR_SIZE};
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = functionCall->parameters_size;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  type_metadata->returnType = copyAstTree(returnType);
+
+  // the arguments of the native function take the types they are given
+  for (size_t i = 0; i < type_metadata->arguments_size; ++i) {
+    AstTree *param = functionCall->parameters[i].value;
+    type_metadata->arguments[i] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(param->type),
+        .name_begin = i < 3 ? NAMES[i] : NULL,
+        .name_end = i < 3 ? NAMES[i] + NAME_SIZES[i] : NULL,
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+  }
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinSpawn(AstTree *tree, AstTreeSetTypesHelper helper,
+                          AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size < 1) {
+    printError(tree->str_begin, tree->str_end, "Too few arguments");
+    return false;
+  }
+
+  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = functionCall->parameters[i];
+    if (param.nameBegin != param.nameEnd) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Bad paramter");
+      return false;
+    }
+  }
+
+  AstTree *function = functionCall->parameters[0].value;
+  if (function->type->token != AST_TREE_TOKEN_TYPE_FUNCTION) {
+    printError(function->str_begin, function->str_end, "Expected function");
+    return false;
+  }
+
+  AstTreeTypeFunction *function_type = function->type->metadata;
+  if (!typeIsEqual(function_type->returnType, &AST_TREE_VOID_TYPE)) {
+    printError(function->str_begin, function->str_end,
+               "Spawned functions must return void");
+    return false;
+  } else if (function_type->arguments_size + 1 !=
+             functionCall->parameters_size) {
+    printError(tree->str_begin, tree->str_end,
+               "Arguments doesn't match %ld != %ld",
+               function_type->arguments_size,
+               functionCall->parameters_size - 1);
+    return false;
+  }
+
+  for (size_t i = 0; i < function_type->arguments_size; ++i) {
+    AstTreeTypeFunctionArgument arg = function_type->arguments[i];
+    AstTree *param = functionCall->parameters[i + 1].value;
+    if (arg.isComptime) {
+      printError(arg.str_begin, arg.str_end,
+                 "Spawned functions can't have comptime arguments");
+      return false;
+    } else if (!typeIsEqual(arg.type, param->type)) {
+      printError(param->str_begin, param->str_end, "Type mismatch");
+      return false;
+    }
+  }
+
+  static const char FUNCTION_STR[] = "function";
+  static const size_t FUNCTION_STR_SIZE =
+      sizeof(FUNCTION_STR) / sizeof(*FUNCTION_STR) - sizeof(*FUNCTION_STR);
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = functionCall->parameters_size;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  // threads are joined by their handle
+  type_metadata->returnType = copyAstTree(&AST_TREE_U64_TYPE);
+
+  type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+      .type = copyAstTree(function->type),
+      .name_begin = FUNCTION_STR,
+      .name_end = FUNCTION_STR + FUNCTION_STR_SIZE,
+      .str_begin = NULL,
+      .str_end = NULL,
+      .isComptime = false,
+  };
+  for (size_t i = 0; i < function_type->arguments_size; ++i) {
+    AstTreeTypeFunctionArgument arg = function_type->arguments[i];
+    type_metadata->arguments[i + 1] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(arg.type),
+        .name_begin = arg.name_begin,
+        .name_end = arg.name_end,
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+  }
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinJoin(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size != 1) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  static const char HANDLE_STR[] = "handle";
+  static const size_t HANDLE_STR_SIZE =
+      sizeof(HANDLE_STR) / sizeof(*HANDLE_STR) - sizeof(*HANDLE_STR);
+
+  AstTreeFunctionCallParam param = functionCall->parameters[0];
+  const size_t param_name_size = param.nameEnd - param.nameBegin;
+  if (param_name_size != 0 &&
+      (param_name_size != HANDLE_STR_SIZE ||
+       !strnEquals(param.nameBegin, HANDLE_STR, HANDLE_STR_SIZE))) {
+    printError(param.value->str_begin, param.value->str_end, "Bad paramter");
+    return false;
+  } else if (!typeIsEqual(param.value->type, &AST_TREE_U64_TYPE)) {
+    printError(param.value->str_begin, param.value->str_end,
+               "Expected handle of @spawn");
+    return false;
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = 1;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  type_metadata->returnType = copyAstTree(&AST_TREE_VOID_TYPE);
+
+  type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+      .type = copyAstTree(&AST_TREE_U64_TYPE),
+      .name_begin = HANDLE_STR,
+      .name_end = HANDLE_STR + HANDLE_STR_SIZE,
+      .str_begin = NULL,
+      .str_end = NULL,
+      .isComptime = false,
+  };
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinAtomic(AstTree *tree, AstTreeSetTypesHelper helper,
+                           AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  static const char POINTER_STR[] = "pointer";
+  static const char VALUE_STR[] = "value";
+  static const char EXPECTED_STR[] = "expected";
+  static const char DESIRED_STR[] = "desired";
+
+  const char *names[3] = {POINTER_STR, VALUE_STR, NULL};
+  size_t arguments_size;
+  switch (tree->token) {
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+    arguments_size = 1;
+    break;
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+    arguments_size = 2;
+    break;
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    arguments_size = 3;
+    names[1] = EXPECTED_STR;
+    names[2] = DESIRED_STR;
+    break;
+  default:
+    UNREACHABLE;
+  }
+
+  if (functionCall->parameters_size != arguments_size) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = functionCall->parameters[i];
+    if (param.nameBegin != param.nameEnd) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Bad paramter");
+      return false;
+    }
+  }
+
+  AstTree *pointer = functionCall->parameters[0].value;
+  if (pointer->type->token != AST_TREE_TOKEN_OPERATOR_POINTER ||
+      !isIntType(pointer->type->metadata)) {
+    printError(pointer->str_begin, pointer->str_end,
+               "Expected pointer to an integer");
+    return false;
+  }
+  AstTree *type = pointer->type->metadata;
+
+  for (size_t i = 1; i < functionCall->parameters_size; ++i) {
+    AstTree *param = functionCall->parameters[i].value;
+    if (!typeIsEqual(param->type, type)) {
+      printError(param->str_begin, param->str_end, "Type mismatch");
+      return false;
+    }
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = arguments_size;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  switch (tree->token) {
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+    // add gives the value before it
+    type_metadata->returnType = copyAstTree(type);
+    break;
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+    type_metadata->returnType = copyAstTree(&AST_TREE_VOID_TYPE);
+    break;
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    type_metadata->returnType = copyAstTree(&AST_TREE_BOOL_TYPE);
+    break;
+  default:
+    UNREACHABLE;
+  }
+
+  for (size_t i = 0; i < arguments_size; ++i) {
+    type_metadata->arguments[i] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(functionCall->parameters[i].value->type),
+        .name_begin = names[i],
+        .name_end = names[i] + strLength(names[i]),
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+  }
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinParallelFor(AstTree *tree, AstTreeSetTypesHelper helper,
+                                AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size < 3) {
+    printError(tree->str_begin, tree->str_end, "Too few arguments");
+    return false;
+  }
+
+  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = functionCall->parameters[i];
+    if (param.nameBegin != param.nameEnd) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Bad paramter");
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    AstTree *param = functionCall->parameters[i].value;
+    if (!typeIsEqual(param->type, &AST_TREE_I64_TYPE)) {
+      printError(param->str_begin, param->str_end, "Expected i64");
+      return false;
+    }
+  }
+
+  AstTree *function = functionCall->parameters[2].value;
+  if (function->type->token != AST_TREE_TOKEN_TYPE_FUNCTION) {
+    printError(function->str_begin, function->str_end, "Expected function");
+    return false;
+  }
+
+  // the function is called with the index and the rest of the arguments
+  AstTreeTypeFunction *function_type = function->type->metadata;
+  if (!typeIsEqual(function_type->returnType, &AST_TREE_VOID_TYPE)) {
+    printError(function->str_begin, function->str_end,
+               "Functions of @parallelFor must return void");
+    return false;
+  } else if (function_type->arguments_size + 2 !=
+             functionCall->parameters_size) {
+    printError(tree->str_begin, tree->str_end,
+               "Arguments doesn't match %ld != %ld",
+               function_type->arguments_size,
+               functionCall->parameters_size - 2);
+    return false;
+  } else if (!typeIsEqual(function_type->arguments[0].type,
+                          &AST_TREE_I64_TYPE)) {
+    printError(function->str_begin, function->str_end,
+               "Expected the index as the first argument of the function");
+    return false;
+  }
+
+  for (size_t i = 0; i < function_type->arguments_size; ++i) {
+    AstTreeTypeFunctionArgument arg = function_type->arguments[i];
+    if (arg.isComptime) {
+      printError(arg.str_begin, arg.str_end,
+                 "Functions of @parallelFor can't have comptime arguments");
+      return false;
+    } else if (i != 0 &&
+               !typeIsEqual(arg.type,
+                            functionCall->parameters[i + 2].value->type)) {
+      AstTree *param = functionCall->parameters[i + 2].value;
+      printError(param->str_begin, param->str_end, "Type mismatch");
+      return false;
+    }
+  }
+
+  static const char BEGIN_STR[] = "begin";
+  static const char END_STR[] = "end";
+  static const char FUNCTION_STR[] = "function";
+  const char *names[] = {BEGIN_STR, END_STR, FUNCTION_STR};
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = functionCall->parameters_size;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  type_metadata->returnType = copyAstTree(&AST_TREE_VOID_TYPE);
+
+  for (size_t i = 0; i < 3; ++i) {
+    type_metadata->arguments[i] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(functionCall->parameters[i].value->type),
+        .name_begin = names[i],
+        .name_end = names[i] + strLength(names[i]),
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+  }
+  for (size_t i = 1; i < function_type->arguments_size; ++i) {
+    AstTreeTypeFunctionArgument arg = function_type->arguments[i];
+    type_metadata->arguments[i + 2] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(arg.type),
+        .name_begin = arg.name_begin,
+        .name_end = arg.name_end,
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+  }
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinGetc(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size != 0) {
+    printError(tree->str_begin, tree->str_end, "Too many arguments");
+    return false;
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = 0;
+  type_metadata->arguments = NULL;
+
+  // the byte or -1 at the end of the input
+  type_metadata->returnType = copyAstTree(&AST_TREE_I32_TYPE);
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinRead(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size != 1) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  static const char BUFFER_STR[] = "buffer";
+  static const size_t BUFFER_STR_SIZE =
+      sizeof(BUFFER_STR) / sizeof(*BUFFER_STR) - sizeof(*BUFFER_STR);
+
+  AstTreeFunctionCallParam param = functionCall->parameters[0];
+  const size_t param_name_size = param.nameEnd - param.nameBegin;
+  if (param_name_size != 0 &&
+      (param_name_size != BUFFER_STR_SIZE ||
+       !strnEquals(param.nameBegin, BUFFER_STR, BUFFER_STR_SIZE))) {
+    printError(param.value->str_begin, param.value->str_end, "Bad paramter");
+    return false;
+  }
+
+  AstTree *buffer = param.value;
+  if (buffer->type->token != AST_TREE_TOKEN_TYPE_ARRAY ||
+      ((AstTreeBracket *)buffer->type->metadata)->parameters.size != 0 ||
+      !typeIsEqual(((AstTreeBracket *)buffer->type->metadata)->operand,
+                   &AST_TREE_U8_TYPE)) {
+    printError(buffer->str_begin, buffer->str_end, "Expected []u8");
+    return false;
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = 1;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  // count of the bytes that are read, 0 at the end of the input
+  type_metadata->returnType = copyAstTree(&AST_TREE_U64_TYPE);
+
+  type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+      .type = copyAstTree(buffer->type),
+      .name_begin = BUFFER_STR,
+      .name_end = BUFFER_STR + BUFFER_STR_SIZE,
+      .str_begin = NULL,
+      .str_end = NULL,
+      .isComptime = false,
+  };
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinMapFile(AstTree *tree, AstTreeSetTypesHelper helper,
+                            AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size != 1) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  static const char PATH_STR[] = "path";
+  static const size_t PATH_STR_SIZE =
+      sizeof(PATH_STR) / sizeof(*PATH_STR) - sizeof(*PATH_STR);
+
+  AstTreeFunctionCallParam param = functionCall->parameters[0];
+  const size_t param_name_size = param.nameEnd - param.nameBegin;
+  if (param_name_size != 0 &&
+      (param_name_size != PATH_STR_SIZE ||
+       !strnEquals(param.nameBegin, PATH_STR, PATH_STR_SIZE))) {
+    printError(param.value->str_begin, param.value->str_end, "Bad paramter");
+    return false;
+  } else if (!isU8Array(param.value->type)) {
+    printError(param.value->str_begin, param.value->str_end,
+               "Expected string");
+    return false;
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = 1;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  // the bytes of the file, they can only be read and they are valid until
+  // they are given to @unmapFile
+  AstTreeBracket *slice_metadata = a404m_malloc(sizeof(*slice_metadata));
+  slice_metadata->operand = copyAstTree(&AST_TREE_U8_TYPE);
+  slice_metadata->parameters.data = NULL;
+  slice_metadata->parameters.size = 0;
+  type_metadata->returnType =
+      newAstTree(AST_TREE_TOKEN_TYPE_ARRAY, slice_metadata,
+                 &AST_TREE_TYPE_TYPE, NULL, NULL);
+
+  type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+      .type = copyAstTree(param.value->type),
+      .name_begin = PATH_STR,
+      .name_end = PATH_STR + PATH_STR_SIZE,
+      .str_begin = NULL,
+      .str_end = NULL,
+      .isComptime = false,
+  };
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinUnmapFile(AstTree *tree, AstTreeSetTypesHelper helper,
+                              AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size != 1) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  static const char SLICE_STR[] = "slice";
+  static const size_t SLICE_STR_SIZE =
+      sizeof(SLICE_STR) / sizeof(*SLICE_STR) - sizeof(*SLICE_STR);
+
+  AstTreeFunctionCallParam param = functionCall->parameters[0];
+  const size_t param_name_size = param.nameEnd - param.nameBegin;
+  if (param_name_size != 0 &&
+      (param_name_size != SLICE_STR_SIZE ||
+       !strnEquals(param.nameBegin, SLICE_STR, SLICE_STR_SIZE))) {
+    printError(param.value->str_begin, param.value->str_end, "Bad paramter");
+    return false;
+  }
+
+  AstTree *slice = param.value;
+  if (slice->type->token != AST_TREE_TOKEN_TYPE_ARRAY ||
+      ((AstTreeBracket *)slice->type->metadata)->parameters.size != 0 ||
+      !typeIsEqual(((AstTreeBracket *)slice->type->metadata)->operand,
+                   &AST_TREE_U8_TYPE)) {
+    printError(slice->str_begin, slice->str_end, "Expected []u8");
+    return false;
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = 1;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  type_metadata->returnType = copyAstTree(&AST_TREE_VOID_TYPE);
+
+  type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+      .type = copyAstTree(slice->type),
+      .name_begin = SLICE_STR,
+      .name_end = SLICE_STR + SLICE_STR_SIZE,
+      .str_begin = NULL,
+      .str_end = NULL,
+      .isComptime = false,
+  };
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+// element of []T and [N]T when it is kept flat in the bytes of the array
+static AstTree *memoryElementType(AstTree *type) {
+  if (type->token != AST_TREE_TOKEN_TYPE_ARRAY) {
+    return NULL;
+  }
+  AstTree *element = ((AstTreeBracket *)type->metadata)->operand;
+  return isRawType(element) ? element : NULL;
+}
+
+bool setTypesBuiltinMemory(AstTree *tree, AstTreeSetTypesHelper helper,
+                           AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  static const char DESTINATION_STR[] = "destination";
+  static const char SOURCE_STR[] = "source";
+  static const char VALUE_STR[] = "value";
+  static const char LEFT_STR[] = "left";
+  static const char RIGHT_STR[] = "right";
+
+  const char *names[2];
+  switch (tree->token) {
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+    names[0] = DESTINATION_STR;
+    names[1] = SOURCE_STR;
+    break;
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+    names[0] = DESTINATION_STR;
+    names[1] = VALUE_STR;
+    break;
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+    names[0] = LEFT_STR;
+    names[1] = RIGHT_STR;
+    break;
+  default:
+    UNREACHABLE;
+  }
+
+  if (functionCall->parameters_size != 2) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = functionCall->parameters[i];
+    if (param.nameBegin != param.nameEnd) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Bad paramter");
+      return false;
+    }
+  }
+
+  AstTree *first = functionCall->parameters[0].value;
+  AstTree *second = functionCall->parameters[1].value;
+  AstTree *element;
+  if (tree->token == AST_TREE_TOKEN_BUILTIN_MEMCMP) {
+    element = memoryElementType(first->type);
+  } else if (first->type->token == AST_TREE_TOKEN_OPERATOR_POINTER) {
+    // sized arrays are values so they are written through their variable
+    element = memoryElementType(first->type->metadata);
+  } else if (first->type->token == AST_TREE_TOKEN_TYPE_ARRAY &&
+             ((AstTreeBracket *)first->type->metadata)->parameters.size ==
+                 0) {
+    element = memoryElementType(first->type);
+  } else {
+    element = NULL;
+  }
+  if (element == NULL) {
+    printError(first->str_begin, first->str_end,
+               tree->token == AST_TREE_TOKEN_BUILTIN_MEMCMP
+                   ? "Expected array of int, float or bool"
+                   : "Expected slice or pointer to array of int, float or "
+                     "bool");
+    return false;
+  }
+
+  if (tree->token == AST_TREE_TOKEN_BUILTIN_MEMSET) {
+    if (!typeIsEqual(second->type, element)) {
+      printError(second->str_begin, second->str_end, "Type mismatch");
+      return false;
+    }
+  } else {
+    AstTree *second_element = memoryElementType(second->type);
+    if (second_element == NULL || !typeIsEqual(second_element, element)) {
+      printError(second->str_begin, second->str_end, "Type mismatch");
+      return false;
+    }
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = 2;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  if (tree->token == AST_TREE_TOKEN_BUILTIN_MEMCMP) {
+    // sign of the first byte that differs like memcmp of C
+    type_metadata->returnType = copyAstTree(&AST_TREE_I32_TYPE);
+  } else {
+    type_metadata->returnType = copyAstTree(&AST_TREE_VOID_TYPE);
+  }
+
+  for (size_t i = 0; i < type_metadata->arguments_size; ++i) {
+    type_metadata->arguments[i] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(functionCall->parameters[i].value->type),
+        .name_begin = names[i],
+        .name_end = names[i] + strLength(names[i]),
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+  }
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinReduce(AstTree *tree, AstTreeSetTypesHelper helper,
+                           AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  static const char ARRAY_STR[] = "array";
+  static const char LEFT_STR[] = "left";
+  static const char RIGHT_STR[] = "right";
+
+  const char *names[2];
+  size_t arguments_size;
+  switch (tree->token) {
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+    names[0] = ARRAY_STR;
+    arguments_size = 1;
+    break;
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+    names[0] = LEFT_STR;
+    names[1] = RIGHT_STR;
+    arguments_size = 2;
+    break;
+  default:
+    UNREACHABLE;
+  }
+
+  if (functionCall->parameters_size != arguments_size) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  AstTree *element = NULL;
+  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = functionCall->parameters[i];
+    if (param.nameBegin != param.nameEnd) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Bad paramter");
+      return false;
+    }
+    AstTree *param_element = memoryElementType(param.value->type);
+    if (param_element == NULL ||
+        typeIsEqual(param_element, &AST_TREE_BOOL_TYPE)) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Expected array of int or float");
+      return false;
+    } else if (element != NULL && !typeIsEqual(param_element, element)) {
+      printError(param.value->str_begin, param.value->str_end,
+                 "Type mismatch");
+      return false;
+    }
+    element = param_element;
+  }
+
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = arguments_size;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+  type_metadata->returnType = copyAstTree(element);
+
+  for (size_t i = 0; i < type_metadata->arguments_size; ++i) {
+    type_metadata->arguments[i] = (AstTreeTypeFunctionArgument){
+        .type = copyAstTree(functionCall->parameters[i].value->type),
+        .name_begin = names[i],
+        .name_end = names[i] + strLength(names[i]),
+        .str_begin = NULL,
+        .str_end = NULL,
+        .isComptime = false,
+    };
+  }
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinUnary(AstTree *tree, AstTreeSetTypesHelper helper,
+                          AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size != 1) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+
+  const char *str = functionCall->parameters[0].nameBegin;
+  const size_t str_size = functionCall->parameters[0].nameEnd -
+                          functionCall->parameters[0].nameBegin;
+
+  static char VALUE_STR[] = "value";
+  static size_t VALUE_STR_SIZE =
+      sizeof(VALUE_STR) / sizeof(*VALUE_STR) - sizeof(*VALUE_STR);
+
+  if (str_size != 0 && (str_size != VALUE_STR_SIZE ||
+                        !strnEquals(str, VALUE_STR, VALUE_STR_SIZE))) {
+    printError(functionCall->parameters[0].nameBegin,
+               functionCall->parameters[0].nameEnd, "Unknown parameter");
+    return false;
+  }
+
+  AstTree *type = functionCall->parameters[0].value->type;
+  switch (type->token) {
+  case AST_TREE_TOKEN_TYPE_I8:
+  case AST_TREE_TOKEN_TYPE_U8:
+  case AST_TREE_TOKEN_TYPE_I16:
+  case AST_TREE_TOKEN_TYPE_U16:
+  case AST_TREE_TOKEN_TYPE_I32:
+  case AST_TREE_TOKEN_TYPE_U32:
+  case AST_TREE_TOKEN_TYPE_I64:
+  case AST_TREE_TOKEN_TYPE_U64:
+  case AST_TREE_TOKEN_TYPE_F16:
+  case AST_TREE_TOKEN_TYPE_F32:
+  case AST_TREE_TOKEN_TYPE_F64:
+  case AST_TREE_TOKEN_TYPE_F128:
+    goto AFTER_SWITCH;
+  case AST_TREE_TOKEN_FUNCTION:
+  case AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_BUILTIN_CAST:
+  case AST_TREE_TOKEN_BUILTIN_TYPE_OF:
+  case AST_TREE_TOKEN_BUILTIN_IMPORT:
+  case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
+  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+  case AST_TREE_TOKEN_BUILTIN_NEG:
+  case AST_TREE_TOKEN_BUILTIN_ADD:
+  case AST_TREE_TOKEN_BUILTIN_SUB:
+  case AST_TREE_TOKEN_BUILTIN_MUL:
+  case AST_TREE_TOKEN_BUILTIN_DIV:
+  case AST_TREE_TOKEN_BUILTIN_MOD:
+  case AST_TREE_TOKEN_BUILTIN_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_NOT_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_GREATER:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER:
+  case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
+  case AST_TREE_TOKEN_KEYWORD_PUTC:
+  case AST_TREE_TOKEN_KEYWORD_RETURN:
+  case AST_TREE_TOKEN_KEYWORD_BREAK:
+  case AST_TREE_TOKEN_KEYWORD_CONTINUE:
+  case AST_TREE_TOKEN_KEYWORD_IF:
+  case AST_TREE_TOKEN_KEYWORD_WHILE:
+  case AST_TREE_TOKEN_KEYWORD_COMPTIME:
+  case AST_TREE_TOKEN_KEYWORD_STRUCT:
+  case AST_TREE_TOKEN_TYPE_FUNCTION:
+  case AST_TREE_TOKEN_TYPE_ARRAY:
+  case AST_TREE_TOKEN_TYPE_TYPE:
+  case AST_TREE_TOKEN_TYPE_VOID:
+  case AST_TREE_TOKEN_TYPE_CODE:
+  case AST_TREE_TOKEN_TYPE_NAMESPACE:
+  case AST_TREE_TOKEN_TYPE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_TYPE_BOOL:
+  case AST_TREE_TOKEN_VALUE_VOID:
+  case AST_TREE_TOKEN_VALUE_NAMESPACE:
+  case AST_TREE_TOKEN_FUNCTION_CALL:
+  case AST_TREE_TOKEN_VARIABLE:
+  case AST_TREE_TOKEN_VARIABLE_DEFINE:
+  case AST_TREE_TOKEN_VALUE_NULL:
+  case AST_TREE_TOKEN_VALUE_UNDEFINED:
+  case AST_TREE_TOKEN_VALUE_INT:
+  case AST_TREE_TOKEN_VALUE_FLOAT:
+  case AST_TREE_TOKEN_VALUE_BOOL:
+  case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
+  case AST_TREE_TOKEN_OPERATOR_ASSIGN:
+  case AST_TREE_TOKEN_OPERATOR_PLUS:
+  case AST_TREE_TOKEN_OPERATOR_MINUS:
+  case AST_TREE_TOKEN_OPERATOR_SUM:
+  case AST_TREE_TOKEN_OPERATOR_SUB:
+  case AST_TREE_TOKEN_OPERATOR_MULTIPLY:
+  case AST_TREE_TOKEN_OPERATOR_DIVIDE:
+  case AST_TREE_TOKEN_OPERATOR_MODULO:
+  case AST_TREE_TOKEN_OPERATOR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_NOT_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_GREATER:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER:
+  case AST_TREE_TOKEN_OPERATOR_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_POINTER:
+  case AST_TREE_TOKEN_OPERATOR_ADDRESS:
+  case AST_TREE_TOKEN_OPERATOR_DEREFERENCE:
+  case AST_TREE_TOKEN_OPERATOR_ACCESS:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_NOT:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_AND:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_OR:
+  case AST_TREE_TOKEN_OPERATOR_ARRAY_ACCESS:
+  case AST_TREE_TOKEN_SCOPE:
+  case AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT:
+  case AST_TREE_TOKEN_NONE:
+  }
+  printError(functionCall->parameters[0].nameBegin,
+             functionCall->parameters[0].nameEnd, "Bad argument");
+  return false;
+
+AFTER_SWITCH:
+  AstTreeTypeFunction *type_metadata = a404m_malloc(sizeof(*type_metadata));
+  type_metadata->arguments_size = 1;
+  type_metadata->arguments = a404m_malloc(type_metadata->arguments_size *
+                                          sizeof(*type_metadata->arguments));
+
+  type_metadata->returnType = copyAstTree(type);
+
+  type_metadata->arguments[0] = (AstTreeTypeFunctionArgument){
+      .type = copyAstTree(type),
+      .name_begin = VALUE_STR,
+      .name_end = VALUE_STR + VALUE_STR_SIZE,
+      .str_begin = NULL,
+      .str_end = NULL,
+      .isComptime = false,
+  };
+
+  tree->type = newAstTree(AST_TREE_TOKEN_TYPE_FUNCTION, type_metadata,
+                          &AST_TREE_TYPE_TYPE, NULL, NULL);
+  return true;
+}
+
+bool setTypesBuiltinBinary(AstTree *tree, AstTreeSetTypesHelper helper,
+                           AstTreeFunctionCall *functionCall) {
+  (void)helper;
+  if (functionCall->parameters_size != 2) {
+    printError(tree->str_begin, tree->str_end, "Too many or too few arguments");
+    return false;
+  }
+  AstTree *left = NULL;
+  AstTree *right = NULL;
+
+  static char LEFT_STR[] = "left";
+  static const size_t LEFT_STR_SIZE =
+      sizeof(LEFT_STR) / sizeof(*LEFT_STR) - sizeof(*LEFT_STR);
+  static char RIGHT_STR[] = "right";
+  static const size_t RIGHT_STR_SIZE =
+      sizeof(RIGHT_STR) / sizeof(*RIGHT_STR) - sizeof(*RIGHT_STR);
+
+  for (size_t i = 0; i < functionCall->parameters_size; ++i) {
+    AstTreeFunctionCallParam param = functionCall->parameters[i];
+    const size_t param_name_size = param.nameEnd - param.nameBegin;
+
+    if (param_name_size == 0) {
+      if (left == NULL) {
+        left = param.value;
+      } else if (right == NULL) {
+        right = param.value;
       } else {
         printError(param.value->str_begin, param.value->str_end,
                    "Bad paramter");
@@ -6391,11 +8183,14 @@ bool setTypesAstFunction(AstTreeFunction *metadata,
   AstTreeVariable *deps[helper.dependencies.size];
   size_t deps_size = 0;
 
+  metadata->slots_size = 0;
+
   for (size_t i = 0; i < metadata->arguments.size; ++i) {
     AstTreeVariable *variable = metadata->arguments.data[i];
     if (!setTypesAstVariable(variable, helper)) {
       return false;
     }
+    variable->slot = metadata->slots_size++;
     helper.variables.data[helper.variables.size++] = variable;
   }
 
@@ -6428,6 +8223,7 @@ bool setTypesAstFunction(AstTreeFunction *metadata,
       if (!setTypesAstVariable(variable, helper)) {
         return false;
       }
+      variable->slot = metadata->slots_size++;
       helper.variables.data[helper.variables.size++] = variable;
     }
     if (!setAllTypes(expr, helper, metadata, NULL)) {
@@ -6435,6 +8231,14 @@ bool setTypesAstFunction(AstTreeFunction *metadata,
     }
   }
 
+  metadata->isLeaf = true;
+  for (size_t i = 0; i < metadata->scope.expressions_size; ++i) {
+    if (!isLeaf(metadata->scope.expressions[i])) {
+      metadata->isLeaf = false;
+      break;
+    }
+  }
+
   return true;
 }
 
@@ -6679,6 +8483,14 @@ AstTreeVariable *setTypesFindVariable(const char *name_begin,
 }
 
 char *u8ArrayToCString(AstTree *tree) {
+  if (tree->token == AST_TREE_TOKEN_RAW_VALUE ||
+      tree->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
+    AstTreeRawValue *raw = tree->metadata;
+    char *str = a404m_malloc((raw->size + 1) * sizeof(*str));
+    memcpy(str, raw->data, raw->size);
+    str[raw->size] = '\0';
+    return str;
+  }
   AstTreeObject *object = tree->metadata;
   char *str = a404m_malloc((object->variables.size + 1) * sizeof(*str));
   for (size_t i = 0; i < object->variables.size; ++i) {
@@ -6738,7 +8550,8 @@ size_t getSizeOfType(AstTree *type) {
     AstTreeBracket *metadata = type->metadata;
     if (metadata->parameters.size == 1 &&
         isIntType(metadata->parameters.data[0]->type)) {
-      return *(AstTreeInt *)metadata->parameters.data[0]->metadata;
+      return *(AstTreeInt *)metadata->parameters.data[0]->metadata *
+             getSizeOfType(metadata->operand);
     } else {
       UNREACHABLE;
     }
@@ -6753,6 +8566,26 @@ size_t getSizeOfType(AstTree *type) {
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -6784,6 +8617,9 @@ size_t getSizeOfType(AstTree *type) {
   case AST_TREE_TOKEN_VALUE_FLOAT:
   case AST_TREE_TOKEN_VALUE_BOOL:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
   case AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT:
   case AST_TREE_TOKEN_OPERATOR_ASSIGN:
   case AST_TREE_TOKEN_OPERATOR_PLUS:
@@ -6812,3 +8648,85 @@ size_t getSizeOfType(AstTree *type) {
   }
   UNREACHABLE;
 }
+
+// owned raw bytes start after a header that counts the values sharing them,
+// the values can be on different threads so the count is atomic
+typedef union RawDataHeader {
+  size_t refs;
+  max_align_t align;
+} RawDataHeader;
+
+u8 *newRawData(size_t size) {
+  RawDataHeader *header = a404m_malloc(sizeof(*header) + size);
+  header->refs = 1;
+  return (u8 *)(header + 1);
+}
+
+u8 *rawDataShare(u8 *data) {
+  RawDataHeader *header = (RawDataHeader *)data - 1;
+  __atomic_add_fetch(&header->refs, 1, __ATOMIC_RELAXED);
+  return data;
+}
+
+void rawDataDelete(u8 *data) {
+  RawDataHeader *header = (RawDataHeader *)data - 1;
+  if (__atomic_sub_fetch(&header->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    free(header);
+  }
+}
+
+bool rawDataIsShared(u8 *data) {
+  RawDataHeader *header = (RawDataHeader *)data - 1;
+  return __atomic_load_n(&header->refs, __ATOMIC_ACQUIRE) != 1;
+}
+
+bool isRawType(AstTree *type) {
+  switch (type->token) {
+  case AST_TREE_TOKEN_TYPE_BOOL:
+  case AST_TREE_TOKEN_TYPE_I8:
+  case AST_TREE_TOKEN_TYPE_U8:
+  case AST_TREE_TOKEN_TYPE_I16:
+  case AST_TREE_TOKEN_TYPE_U16:
+  case AST_TREE_TOKEN_TYPE_I32:
+  case AST_TREE_TOKEN_TYPE_U32:
+  case AST_TREE_TOKEN_TYPE_I64:
+  case AST_TREE_TOKEN_TYPE_U64:
+#ifdef FLOAT_16_SUPPORT
+  case AST_TREE_TOKEN_TYPE_F16:
+#endif
+  case AST_TREE_TOKEN_TYPE_F32:
+  case AST_TREE_TOKEN_TYPE_F64:
+  case AST_TREE_TOKEN_TYPE_F128:
+    // values only keep static types
+    return !astTreeShouldDelete(type);
+  default:
+    return false;
+  }
+}
+
+// members are aligned to their size like C does and const ones take no space
+void setStructLayout(AstTreeStruct *metadata) {
+  free(metadata->offsets);
+  metadata->offsets = NULL;
+  metadata->size = 0;
+
+  for (size_t i = 0; i < metadata->variables.size; ++i) {
+    AstTreeVariable *member = metadata->variables.data[i];
+    if (!member->isConst && !isRawType(member->type)) {
+      return;
+    }
+  }
+
+  metadata->offsets =
+      a404m_malloc(metadata->variables.size * sizeof(*metadata->offsets));
+  for (size_t i = 0; i < metadata->variables.size; ++i) {
+    AstTreeVariable *member = metadata->variables.data[i];
+    if (member->isConst) {
+      metadata->offsets[i] = metadata->size;
+    } else {
+      const size_t size = getSizeOfType(member->type);
+      metadata->offsets[i] = (metadata->size + size - 1) / size * size;
+      metadata->size = metadata->offsets[i] + size;
+    }
+  }
+}
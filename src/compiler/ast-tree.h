@@ -13,6 +13,26 @@ typedef enum AstTreeToken {
   AST_TREE_TOKEN_BUILTIN_IS_COMPTIME,
   AST_TREE_TOKEN_BUILTIN_STACK_ALLOC,
   AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC,
+  AST_TREE_TOKEN_BUILTIN_FREE,
+  AST_TREE_TOKEN_BUILTIN_FFI,
+  AST_TREE_TOKEN_BUILTIN_SPAWN,
+  AST_TREE_TOKEN_BUILTIN_JOIN,
+  AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD,
+  AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE,
+  AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD,
+  AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE,
+  AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR,
+  AST_TREE_TOKEN_BUILTIN_GETC,
+  AST_TREE_TOKEN_BUILTIN_READ,
+  AST_TREE_TOKEN_BUILTIN_MAP_FILE,
+  AST_TREE_TOKEN_BUILTIN_UNMAP_FILE,
+  AST_TREE_TOKEN_BUILTIN_MEMCPY,
+  AST_TREE_TOKEN_BUILTIN_MEMSET,
+  AST_TREE_TOKEN_BUILTIN_MEMCMP,
+  AST_TREE_TOKEN_BUILTIN_SUM,
+  AST_TREE_TOKEN_BUILTIN_MIN,
+  AST_TREE_TOKEN_BUILTIN_MAX,
+  AST_TREE_TOKEN_BUILTIN_DOT,
   AST_TREE_TOKEN_BUILTIN_NEG,
   AST_TREE_TOKEN_BUILTIN_ADD,
   AST_TREE_TOKEN_BUILTIN_SUB,
@@ -73,6 +93,9 @@ typedef enum AstTreeToken {
   AST_TREE_TOKEN_VALUE_FLOAT,
   AST_TREE_TOKEN_VALUE_BOOL,
   AST_TREE_TOKEN_VALUE_OBJECT,
+  AST_TREE_TOKEN_RAW_VALUE,
+  AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED,
+  AST_TREE_TOKEN_THUNK,
 
   AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT,
 
@@ -106,12 +129,18 @@ typedef enum AstTreeToken {
 
 extern const char *AST_TREE_TOKEN_STRINGS[];
 
+// set on threads that @spawn made, the functions that they copy are private
+extern _Thread_local bool AST_TREE_PRIVATE_COPIES;
+
 typedef struct AstTree {
   AstTreeToken token;
   void *metadata;
   struct AstTree *type;
   char const *str_begin;
   char const *str_end;
+  // compile time value of the tree, filled by getValue and dropped with the
+  // tree
+  struct AstTree *constValue;
 } AstTree;
 
 extern AstTree AST_TREE_TYPE_TYPE;
@@ -144,6 +173,12 @@ typedef struct AstTreeVariable {
   AstTree *initValue;
   bool isConst;
   bool isLazy;
+  // lazy and evaluated again on every read instead of once
+  bool isByName;
+  // a variable of a root that all of the threads share
+  bool isGlobal;
+  // index in the frame of the function that owns the variable
+  size_t slot;
 } AstTreeVariable;
 
 typedef struct AstTreeVariables {
@@ -184,6 +219,14 @@ typedef struct AstTreeFunction {
   AstTreeVariables arguments;
   AstTreeScope scope;
   AstTree *returnType;
+  size_t slots_size;
+  // calls that are running it, the runner only shares the function with its
+  // callers when there is none
+  size_t running;
+  // runs no user code other than itself so its temporaries can be in an arena
+  bool isLeaf;
+  // copied by a spawned thread and only run by it
+  bool isPrivate;
 } AstTreeFunction;
 
 typedef struct AstTreeTypeFunctionArgument {
@@ -223,17 +266,37 @@ typedef struct AstTreeObject {
   AstTreeVariables variables;
 } AstTreeObject;
 
+// flat bytes of a value, the data of NOT_OWNED ones belongs to another value
+// and the data of owned ones is shared between copies until one writes to it
+typedef struct AstTreeRawValue {
+  u8 *data;
+  size_t size;
+} AstTreeRawValue;
+
+// value of a lazy variable, expr belongs to the caller and value keeps the
+// result of the first evaluation unless it is by name
+typedef struct AstTreeThunk {
+  AstTree *expr;
+  AstTree *value;
+  bool isByName;
+} AstTreeThunk;
+
 typedef AstTree AstTreeSingleChild;
 
 typedef struct AstTreeUnary {
   AstTree *operand;
   AstTreeVariable *function;
+  // builtin that function only forwards to or AST_TREE_TOKEN_NONE
+  AstTreeToken builtin;
 } AstTreeUnary;
 
 typedef struct AstTreeInfix {
   AstTree *left;
   AstTree *right;
   AstTreeVariable *function;
+  // builtin that function only forwards to, the operator itself when it is a
+  // native short circuit or AST_TREE_TOKEN_NONE
+  AstTreeToken builtin;
 } AstTreeInfix;
 
 typedef struct AstTreeReturn {
@@ -263,6 +326,9 @@ typedef struct AstTreeSetTypesHelper {
 typedef struct AstTreeStruct {
   size_t id;
   AstTreeVariables variables;
+  // byte offset of each member when the values are flat or NULL
+  size_t *offsets;
+  size_t size;
 } AstTreeStruct;
 
 typedef struct AstTreeName {
@@ -339,6 +405,9 @@ AstTreeFunction *copyAstTreeFunction(AstTreeFunction *function,
                                      AstTreeVariables oldVariables[],
                                      AstTreeVariables newVariables[],
                                      size_t variables_size, bool safetyCheck);
+// private copy for a spawned thread, the function may be running on other
+// threads so the values of its non const locals are not read
+AstTreeFunction *copyAstTreeFunctionForThread(AstTreeFunction *function);
 
 AstTreeRoots makeAstTree(const char *filePath
 #ifdef PRINT_STATISTICS
@@ -394,13 +463,25 @@ AstTree *astTreeParseBracket(const ParserNode *parserNode, AstTreeToken token);
 bool isFunction(AstTree *value);
 bool isShapeShifter(AstTreeFunction *function);
 bool isConst(AstTree *tree);
+AstTreeToken getForwardedBuiltin(AstTreeVariable *variable);
+bool isShortCircuit(AstTreeVariable *variable, bool isAnd);
+bool isLeaf(AstTree *tree);
 AstTree *makeTypeOf(AstTree *value);
 AstTree *makeTypeOfFunction(AstTreeFunction *function, const char *str_begin,
                             const char *str_end);
 bool typeIsEqual(AstTree *type0, AstTree *type1);
 bool typeIsEqualBack(const AstTree *type0, const AstTree *type1);
+// evaluates a const tree once and keeps the value on it, the result is owned
+// by the tree
+AstTree *getConstValue(AstTree *tree);
 AstTree *getValue(AstTree *tree, bool copy);
 bool isIntType(AstTree *type);
+bool isRawType(AstTree *type);
+
+u8 *newRawData(size_t size);
+u8 *rawDataShare(u8 *data);
+void rawDataDelete(u8 *data);
+bool rawDataIsShared(u8 *data);
 bool isEqual(AstTree *left, AstTree *right);
 bool isEqualVariable(AstTreeVariable *left, AstTreeVariable *right);
 
@@ -455,10 +536,32 @@ bool setTypesBuiltinTypeOf(AstTree *tree, AstTreeSetTypesHelper helper,
 bool setTypesBuiltinImport(AstTree *tree, AstTreeSetTypesHelper helper,
                            AstTreeFunctionCall *functionCall);
 bool setTypesBuiltinIsComptime(AstTree *tree, AstTreeSetTypesHelper helper);
-bool setTypesBuiltinStackAlloc(AstTree *tree, AstTreeSetTypesHelper helper,
-                               AstTreeFunctionCall *functionCall);
-bool setTypesBuiltinHeapAlloc(AstTree *tree, AstTreeSetTypesHelper helper,
+bool setTypesBuiltinAlloc(AstTree *tree, AstTreeSetTypesHelper helper,
+                          AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinFree(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinFfi(AstTree *tree, AstTreeSetTypesHelper helper,
+                        AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinSpawn(AstTree *tree, AstTreeSetTypesHelper helper,
+                          AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinJoin(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinAtomic(AstTree *tree, AstTreeSetTypesHelper helper,
+                           AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinParallelFor(AstTree *tree, AstTreeSetTypesHelper helper,
+                                AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinGetc(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinRead(AstTree *tree, AstTreeSetTypesHelper helper,
+                         AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinMapFile(AstTree *tree, AstTreeSetTypesHelper helper,
+                            AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinUnmapFile(AstTree *tree, AstTreeSetTypesHelper helper,
                               AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinMemory(AstTree *tree, AstTreeSetTypesHelper helper,
+                           AstTreeFunctionCall *functionCall);
+bool setTypesBuiltinReduce(AstTree *tree, AstTreeSetTypesHelper helper,
+                           AstTreeFunctionCall *functionCall);
 bool setTypesBuiltinUnary(AstTree *tree, AstTreeSetTypesHelper helper,
                           AstTreeFunctionCall *functionCall);
 bool setTypesBuiltinBinary(AstTree *tree, AstTreeSetTypesHelper helper,
@@ -485,3 +588,4 @@ char *u8ArrayToCString(AstTree *tree);
 AstTree *makeStringType();
 
 size_t getSizeOfType(AstTree *type);
+void setStructLayout(AstTreeStruct *metadata);
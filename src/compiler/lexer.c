@@ -17,6 +17,26 @@ const char *LEXER_TOKEN_STRINGS[] = {
     "LEXER_TOKEN_BUILTIN_IS_COMPTIME",
     "LEXER_TOKEN_BUILTIN_STACK_ALLOC",
     "LEXER_TOKEN_BUILTIN_HEAP_ALLOC",
+    "LEXER_TOKEN_BUILTIN_FREE",
+    "LEXER_TOKEN_BUILTIN_FFI",
+    "LEXER_TOKEN_BUILTIN_SPAWN",
+    "LEXER_TOKEN_BUILTIN_JOIN",
+    "LEXER_TOKEN_BUILTIN_ATOMIC_LOAD",
+    "LEXER_TOKEN_BUILTIN_ATOMIC_STORE",
+    "LEXER_TOKEN_BUILTIN_ATOMIC_ADD",
+    "LEXER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE",
+    "LEXER_TOKEN_BUILTIN_PARALLEL_FOR",
+    "LEXER_TOKEN_BUILTIN_GETC",
+    "LEXER_TOKEN_BUILTIN_READ",
+    "LEXER_TOKEN_BUILTIN_MAP_FILE",
+    "LEXER_TOKEN_BUILTIN_UNMAP_FILE",
+    "LEXER_TOKEN_BUILTIN_MEMCPY",
+    "LEXER_TOKEN_BUILTIN_MEMSET",
+    "LEXER_TOKEN_BUILTIN_MEMCMP",
+    "LEXER_TOKEN_BUILTIN_SUM",
+    "LEXER_TOKEN_BUILTIN_MIN",
+    "LEXER_TOKEN_BUILTIN_MAX",
+    "LEXER_TOKEN_BUILTIN_DOT",
     "LEXER_TOKEN_BUILTIN_NEG",
     "LEXER_TOKEN_BUILTIN_ADD",
     "LEXER_TOKEN_BUILTIN_SUB",
@@ -116,6 +136,7 @@ const char *LEXER_TOKEN_STRINGS[] = {
     "LEXER_TOKEN_SYMBOL_OPEN_BRACKET",
     "LEXER_TOKEN_SYMBOL_OPEN_CURLY_BRACKET",
     "LEXER_TOKEN_KEYWORD_LAZY",
+    "LEXER_TOKEN_KEYWORD_BYNAME",
 
     "LEXER_TOKEN_NONE",
 };
@@ -172,7 +193,7 @@ static const char *LEXER_KEYWORD_STRINGS[] = {
     "f32",           "f64",    "f128",      "bool", "putc",  "return",
     "true",          "false",  "if",        "else", "while", "comptime",
     "null",          "struct", "undefined", "code", "lazy",  "namespace",
-    "shape_shifter", "break",  "continue",
+    "shape_shifter", "break",  "continue",  "byname",
 };
 static const LexerToken LEXER_KEYWORD_TOKENS[] = {
     LEXER_TOKEN_KEYWORD_TYPE,
@@ -209,6 +230,7 @@ static const LexerToken LEXER_KEYWORD_TOKENS[] = {
     LEXER_TOKEN_KEYWORD_SHAPE_SHIFTER,
     LEXER_TOKEN_KEYWORD_BREAK,
     LEXER_TOKEN_KEYWORD_CONTINUE,
+    LEXER_TOKEN_KEYWORD_BYNAME,
 };
 static const size_t LEXER_KEYWORD_SIZE =
     sizeof(LEXER_KEYWORD_TOKENS) / sizeof(*LEXER_KEYWORD_TOKENS);
@@ -220,6 +242,26 @@ static const char *LEXER_BUILTIN_STRINGS[] = {
     "isComptime",
     "stackAlloc",
     "heapAlloc",
+    "free",
+    "ffi",
+    "spawn",
+    "join",
+    "atomicLoad",
+    "atomicStore",
+    "atomicAdd",
+    "atomicCompareExchange",
+    "parallelFor",
+    "getc",
+    "read",
+    "mapFile",
+    "unmapFile",
+    "memcpy",
+    "memset",
+    "memcmp",
+    "sum",
+    "min",
+    "max",
+    "dot",
     "neg",
     "add",
     "sub",
@@ -241,6 +283,26 @@ static const LexerToken LEXER_BUILTIN_TOKENS[] = {
     LEXER_TOKEN_BUILTIN_IS_COMPTIME,
     LEXER_TOKEN_BUILTIN_STACK_ALLOC,
     LEXER_TOKEN_BUILTIN_HEAP_ALLOC,
+    LEXER_TOKEN_BUILTIN_FREE,
+    LEXER_TOKEN_BUILTIN_FFI,
+    LEXER_TOKEN_BUILTIN_SPAWN,
+    LEXER_TOKEN_BUILTIN_JOIN,
+    LEXER_TOKEN_BUILTIN_ATOMIC_LOAD,
+    LEXER_TOKEN_BUILTIN_ATOMIC_STORE,
+    LEXER_TOKEN_BUILTIN_ATOMIC_ADD,
+    LEXER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE,
+    LEXER_TOKEN_BUILTIN_PARALLEL_FOR,
+    LEXER_TOKEN_BUILTIN_GETC,
+    LEXER_TOKEN_BUILTIN_READ,
+    LEXER_TOKEN_BUILTIN_MAP_FILE,
+    LEXER_TOKEN_BUILTIN_UNMAP_FILE,
+    LEXER_TOKEN_BUILTIN_MEMCPY,
+    LEXER_TOKEN_BUILTIN_MEMSET,
+    LEXER_TOKEN_BUILTIN_MEMCMP,
+    LEXER_TOKEN_BUILTIN_SUM,
+    LEXER_TOKEN_BUILTIN_MIN,
+    LEXER_TOKEN_BUILTIN_MAX,
+    LEXER_TOKEN_BUILTIN_DOT,
     LEXER_TOKEN_BUILTIN_NEG,
     LEXER_TOKEN_BUILTIN_ADD,
     LEXER_TOKEN_BUILTIN_SUB,
@@ -464,6 +526,7 @@ lexerPushClear(LexerNodeArray *array, size_t *array_size, char const *iter,
   case LEXER_TOKEN_KEYWORD_CODE:
   case LEXER_TOKEN_KEYWORD_NAMESPACE:
   case LEXER_TOKEN_KEYWORD_LAZY:
+  case LEXER_TOKEN_KEYWORD_BYNAME:
   case LEXER_TOKEN_NUMBER:
   case LEXER_TOKEN_CHAR:
   case LEXER_TOKEN_STRING:
@@ -508,6 +571,26 @@ lexerPushClear(LexerNodeArray *array, size_t *array_size, char const *iter,
   case LEXER_TOKEN_BUILTIN_IS_COMPTIME:
   case LEXER_TOKEN_BUILTIN_STACK_ALLOC:
   case LEXER_TOKEN_BUILTIN_HEAP_ALLOC:
+  case LEXER_TOKEN_BUILTIN_FREE:
+  case LEXER_TOKEN_BUILTIN_FFI:
+  case LEXER_TOKEN_BUILTIN_SPAWN:
+  case LEXER_TOKEN_BUILTIN_JOIN:
+  case LEXER_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case LEXER_TOKEN_BUILTIN_ATOMIC_STORE:
+  case LEXER_TOKEN_BUILTIN_ATOMIC_ADD:
+  case LEXER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case LEXER_TOKEN_BUILTIN_PARALLEL_FOR:
+  case LEXER_TOKEN_BUILTIN_GETC:
+  case LEXER_TOKEN_BUILTIN_READ:
+  case LEXER_TOKEN_BUILTIN_MAP_FILE:
+  case LEXER_TOKEN_BUILTIN_UNMAP_FILE:
+  case LEXER_TOKEN_BUILTIN_MEMCPY:
+  case LEXER_TOKEN_BUILTIN_MEMSET:
+  case LEXER_TOKEN_BUILTIN_MEMCMP:
+  case LEXER_TOKEN_BUILTIN_SUM:
+  case LEXER_TOKEN_BUILTIN_MIN:
+  case LEXER_TOKEN_BUILTIN_MAX:
+  case LEXER_TOKEN_BUILTIN_DOT:
   case LEXER_TOKEN_BUILTIN_NEG:
   case LEXER_TOKEN_BUILTIN_ADD:
   case LEXER_TOKEN_BUILTIN_SUB:
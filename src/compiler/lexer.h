@@ -19,6 +19,26 @@ typedef enum LexerToken {
   LEXER_TOKEN_BUILTIN_IS_COMPTIME,
   LEXER_TOKEN_BUILTIN_STACK_ALLOC,
   LEXER_TOKEN_BUILTIN_HEAP_ALLOC,
+  LEXER_TOKEN_BUILTIN_FREE,
+  LEXER_TOKEN_BUILTIN_FFI,
+  LEXER_TOKEN_BUILTIN_SPAWN,
+  LEXER_TOKEN_BUILTIN_JOIN,
+  LEXER_TOKEN_BUILTIN_ATOMIC_LOAD,
+  LEXER_TOKEN_BUILTIN_ATOMIC_STORE,
+  LEXER_TOKEN_BUILTIN_ATOMIC_ADD,
+  LEXER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE,
+  LEXER_TOKEN_BUILTIN_PARALLEL_FOR,
+  LEXER_TOKEN_BUILTIN_GETC,
+  LEXER_TOKEN_BUILTIN_READ,
+  LEXER_TOKEN_BUILTIN_MAP_FILE,
+  LEXER_TOKEN_BUILTIN_UNMAP_FILE,
+  LEXER_TOKEN_BUILTIN_MEMCPY,
+  LEXER_TOKEN_BUILTIN_MEMSET,
+  LEXER_TOKEN_BUILTIN_MEMCMP,
+  LEXER_TOKEN_BUILTIN_SUM,
+  LEXER_TOKEN_BUILTIN_MIN,
+  LEXER_TOKEN_BUILTIN_MAX,
+  LEXER_TOKEN_BUILTIN_DOT,
   LEXER_TOKEN_BUILTIN_NEG,
   LEXER_TOKEN_BUILTIN_ADD,
   LEXER_TOKEN_BUILTIN_SUB,
@@ -131,6 +151,7 @@ typedef enum LexerToken {
   LEXER_TOKEN_SYMBOL_OPEN_BRACKET,
   LEXER_TOKEN_SYMBOL_OPEN_CURLY_BRACKET,
   LEXER_TOKEN_KEYWORD_LAZY,
+  LEXER_TOKEN_KEYWORD_BYNAME,
 
   LEXER_TOKEN_NONE,
 } LexerToken;
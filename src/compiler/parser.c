@@ -18,6 +18,26 @@ const char *PARSER_TOKEN_STRINGS[] = {
     "PARSER_TOKEN_BUILTIN_IS_COMPTIME",
     "PARSER_TOKEN_BUILTIN_STACK_ALLOC",
     "PARSER_TOKEN_BUILTIN_HEAP_ALLOC",
+    "PARSER_TOKEN_BUILTIN_FREE",
+    "PARSER_TOKEN_BUILTIN_FFI",
+    "PARSER_TOKEN_BUILTIN_SPAWN",
+    "PARSER_TOKEN_BUILTIN_JOIN",
+    "PARSER_TOKEN_BUILTIN_ATOMIC_LOAD",
+    "PARSER_TOKEN_BUILTIN_ATOMIC_STORE",
+    "PARSER_TOKEN_BUILTIN_ATOMIC_ADD",
+    "PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE",
+    "PARSER_TOKEN_BUILTIN_PARALLEL_FOR",
+    "PARSER_TOKEN_BUILTIN_GETC",
+    "PARSER_TOKEN_BUILTIN_READ",
+    "PARSER_TOKEN_BUILTIN_MAP_FILE",
+    "PARSER_TOKEN_BUILTIN_UNMAP_FILE",
+    "PARSER_TOKEN_BUILTIN_MEMCPY",
+    "PARSER_TOKEN_BUILTIN_MEMSET",
+    "PARSER_TOKEN_BUILTIN_MEMCMP",
+    "PARSER_TOKEN_BUILTIN_SUM",
+    "PARSER_TOKEN_BUILTIN_MIN",
+    "PARSER_TOKEN_BUILTIN_MAX",
+    "PARSER_TOKEN_BUILTIN_DOT",
     "PARSER_TOKEN_BUILTIN_NEG",
     "PARSER_TOKEN_BUILTIN_ADD",
     "PARSER_TOKEN_BUILTIN_SUB",
@@ -248,6 +268,26 @@ void parserNodePrint(const ParserNode *node, int indent) {
   case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
   case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
   case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+  case PARSER_TOKEN_BUILTIN_FREE:
+  case PARSER_TOKEN_BUILTIN_FFI:
+  case PARSER_TOKEN_BUILTIN_SPAWN:
+  case PARSER_TOKEN_BUILTIN_JOIN:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+  case PARSER_TOKEN_BUILTIN_GETC:
+  case PARSER_TOKEN_BUILTIN_READ:
+  case PARSER_TOKEN_BUILTIN_MAP_FILE:
+  case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+  case PARSER_TOKEN_BUILTIN_MEMCPY:
+  case PARSER_TOKEN_BUILTIN_MEMSET:
+  case PARSER_TOKEN_BUILTIN_MEMCMP:
+  case PARSER_TOKEN_BUILTIN_SUM:
+  case PARSER_TOKEN_BUILTIN_MIN:
+  case PARSER_TOKEN_BUILTIN_MAX:
+  case PARSER_TOKEN_BUILTIN_DOT:
   case PARSER_TOKEN_BUILTIN_NEG:
   case PARSER_TOKEN_BUILTIN_ADD:
   case PARSER_TOKEN_BUILTIN_SUB:
@@ -314,7 +354,7 @@ void parserNodePrint(const ParserNode *node, int indent) {
   case PARSER_TOKEN_CONSTANT:
   case PARSER_TOKEN_VARIABLE: {
     const ParserNodeVariableMetadata *metadata = node->metadata;
-    printf("isLazy=%b,\n", metadata->isLazy);
+    printf("isLazy=%b,isByName=%b,\n", metadata->isLazy, metadata->isByName);
     for (int i = 0; i < indent; ++i)
       printf(" ");
     printf("name=\n");
@@ -553,6 +593,26 @@ void parserNodeDelete(ParserNode *node) {
   case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
   case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
   case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+  case PARSER_TOKEN_BUILTIN_FREE:
+  case PARSER_TOKEN_BUILTIN_FFI:
+  case PARSER_TOKEN_BUILTIN_SPAWN:
+  case PARSER_TOKEN_BUILTIN_JOIN:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+  case PARSER_TOKEN_BUILTIN_GETC:
+  case PARSER_TOKEN_BUILTIN_READ:
+  case PARSER_TOKEN_BUILTIN_MAP_FILE:
+  case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+  case PARSER_TOKEN_BUILTIN_MEMCPY:
+  case PARSER_TOKEN_BUILTIN_MEMSET:
+  case PARSER_TOKEN_BUILTIN_MEMCMP:
+  case PARSER_TOKEN_BUILTIN_SUM:
+  case PARSER_TOKEN_BUILTIN_MIN:
+  case PARSER_TOKEN_BUILTIN_MAX:
+  case PARSER_TOKEN_BUILTIN_DOT:
   case PARSER_TOKEN_BUILTIN_NEG:
   case PARSER_TOKEN_BUILTIN_ADD:
   case PARSER_TOKEN_BUILTIN_SUB:
@@ -862,6 +922,47 @@ ParserNode *parseNode(LexerNode *node, LexerNode *begin, LexerNode *end,
     return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_STACK_ALLOC);
   case LEXER_TOKEN_BUILTIN_HEAP_ALLOC:
     return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_HEAP_ALLOC);
+  case LEXER_TOKEN_BUILTIN_FREE:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_FREE);
+  case LEXER_TOKEN_BUILTIN_FFI:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_FFI);
+  case LEXER_TOKEN_BUILTIN_SPAWN:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_SPAWN);
+  case LEXER_TOKEN_BUILTIN_JOIN:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_JOIN);
+  case LEXER_TOKEN_BUILTIN_ATOMIC_LOAD:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_ATOMIC_LOAD);
+  case LEXER_TOKEN_BUILTIN_ATOMIC_STORE:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_ATOMIC_STORE);
+  case LEXER_TOKEN_BUILTIN_ATOMIC_ADD:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_ATOMIC_ADD);
+  case LEXER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    return parserNoMetadata(node, parent,
+                            PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE);
+  case LEXER_TOKEN_BUILTIN_PARALLEL_FOR:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_PARALLEL_FOR);
+  case LEXER_TOKEN_BUILTIN_GETC:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_GETC);
+  case LEXER_TOKEN_BUILTIN_READ:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_READ);
+  case LEXER_TOKEN_BUILTIN_MAP_FILE:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_MAP_FILE);
+  case LEXER_TOKEN_BUILTIN_UNMAP_FILE:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_UNMAP_FILE);
+  case LEXER_TOKEN_BUILTIN_MEMCPY:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_MEMCPY);
+  case LEXER_TOKEN_BUILTIN_MEMSET:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_MEMSET);
+  case LEXER_TOKEN_BUILTIN_MEMCMP:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_MEMCMP);
+  case LEXER_TOKEN_BUILTIN_SUM:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_SUM);
+  case LEXER_TOKEN_BUILTIN_MIN:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_MIN);
+  case LEXER_TOKEN_BUILTIN_MAX:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_MAX);
+  case LEXER_TOKEN_BUILTIN_DOT:
+    return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_DOT);
   case LEXER_TOKEN_BUILTIN_NEG:
     return parserNoMetadata(node, parent, PARSER_TOKEN_BUILTIN_NEG);
   case LEXER_TOKEN_BUILTIN_ADD:
@@ -1070,6 +1171,7 @@ ParserNode *parseNode(LexerNode *node, LexerNode *begin, LexerNode *end,
   case LEXER_TOKEN_KEYWORD_STRUCT:
     return parserStruct(node, end, parent);
   case LEXER_TOKEN_KEYWORD_LAZY:
+  case LEXER_TOKEN_KEYWORD_BYNAME:
   case LEXER_TOKEN_KEYWORD_ELSE:
   case LEXER_TOKEN_BUILTIN:
   case LEXER_TOKEN_SYMBOL:
@@ -1684,6 +1786,26 @@ ParserNode *parserFunction(LexerNode *node, LexerNode *begin, LexerNode *end,
       case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
       case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
       case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+      case PARSER_TOKEN_BUILTIN_FREE:
+      case PARSER_TOKEN_BUILTIN_FFI:
+      case PARSER_TOKEN_BUILTIN_SPAWN:
+      case PARSER_TOKEN_BUILTIN_JOIN:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+      case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+      case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+      case PARSER_TOKEN_BUILTIN_GETC:
+      case PARSER_TOKEN_BUILTIN_READ:
+      case PARSER_TOKEN_BUILTIN_MAP_FILE:
+      case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+      case PARSER_TOKEN_BUILTIN_MEMCPY:
+      case PARSER_TOKEN_BUILTIN_MEMSET:
+      case PARSER_TOKEN_BUILTIN_MEMCMP:
+      case PARSER_TOKEN_BUILTIN_SUM:
+      case PARSER_TOKEN_BUILTIN_MIN:
+      case PARSER_TOKEN_BUILTIN_MAX:
+      case PARSER_TOKEN_BUILTIN_DOT:
       case PARSER_TOKEN_BUILTIN_NEG:
       case PARSER_TOKEN_BUILTIN_ADD:
       case PARSER_TOKEN_BUILTIN_SUB:
@@ -1902,6 +2024,7 @@ ParserNode *parserVariable(LexerNode *node, LexerNode *begin, LexerNode *end,
   metadata->type = type;
   metadata->isComptime = false;
   metadata->isLazy = false;
+  metadata->isByName = false;
 
   LexerNode *flagNode = nameNode - 1;
   while (flagNode >= begin && flagNode->parserNode == NULL) {
@@ -1909,6 +2032,10 @@ ParserNode *parserVariable(LexerNode *node, LexerNode *begin, LexerNode *end,
     case LEXER_TOKEN_KEYWORD_LAZY:
       metadata->isLazy = true;
       break;
+    case LEXER_TOKEN_KEYWORD_BYNAME:
+      metadata->isLazy = true;
+      metadata->isByName = true;
+      break;
     case LEXER_TOKEN_KEYWORD_COMPTIME:
       metadata->isComptime = true;
       break;
@@ -2185,6 +2312,26 @@ bool isExpression(ParserNode *node) {
   case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
   case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
   case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+  case PARSER_TOKEN_BUILTIN_FREE:
+  case PARSER_TOKEN_BUILTIN_FFI:
+  case PARSER_TOKEN_BUILTIN_SPAWN:
+  case PARSER_TOKEN_BUILTIN_JOIN:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+  case PARSER_TOKEN_BUILTIN_GETC:
+  case PARSER_TOKEN_BUILTIN_READ:
+  case PARSER_TOKEN_BUILTIN_MAP_FILE:
+  case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+  case PARSER_TOKEN_BUILTIN_MEMCPY:
+  case PARSER_TOKEN_BUILTIN_MEMSET:
+  case PARSER_TOKEN_BUILTIN_MEMCMP:
+  case PARSER_TOKEN_BUILTIN_SUM:
+  case PARSER_TOKEN_BUILTIN_MIN:
+  case PARSER_TOKEN_BUILTIN_MAX:
+  case PARSER_TOKEN_BUILTIN_DOT:
   case PARSER_TOKEN_BUILTIN_NEG:
   case PARSER_TOKEN_BUILTIN_ADD:
   case PARSER_TOKEN_BUILTIN_SUB:
@@ -2318,6 +2465,26 @@ bool isType(ParserNode *node) {
   case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
   case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
   case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+  case PARSER_TOKEN_BUILTIN_FREE:
+  case PARSER_TOKEN_BUILTIN_FFI:
+  case PARSER_TOKEN_BUILTIN_SPAWN:
+  case PARSER_TOKEN_BUILTIN_JOIN:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+  case PARSER_TOKEN_BUILTIN_GETC:
+  case PARSER_TOKEN_BUILTIN_READ:
+  case PARSER_TOKEN_BUILTIN_MAP_FILE:
+  case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+  case PARSER_TOKEN_BUILTIN_MEMCPY:
+  case PARSER_TOKEN_BUILTIN_MEMSET:
+  case PARSER_TOKEN_BUILTIN_MEMCMP:
+  case PARSER_TOKEN_BUILTIN_SUM:
+  case PARSER_TOKEN_BUILTIN_MIN:
+  case PARSER_TOKEN_BUILTIN_MAX:
+  case PARSER_TOKEN_BUILTIN_DOT:
   case PARSER_TOKEN_BUILTIN_NEG:
   case PARSER_TOKEN_BUILTIN_ADD:
   case PARSER_TOKEN_BUILTIN_SUB:
@@ -2394,6 +2561,26 @@ bool isValue(ParserNode *node) {
   case PARSER_TOKEN_BUILTIN_IS_COMPTIME:
   case PARSER_TOKEN_BUILTIN_STACK_ALLOC:
   case PARSER_TOKEN_BUILTIN_HEAP_ALLOC:
+  case PARSER_TOKEN_BUILTIN_FREE:
+  case PARSER_TOKEN_BUILTIN_FFI:
+  case PARSER_TOKEN_BUILTIN_SPAWN:
+  case PARSER_TOKEN_BUILTIN_JOIN:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_STORE:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_ADD:
+  case PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case PARSER_TOKEN_BUILTIN_PARALLEL_FOR:
+  case PARSER_TOKEN_BUILTIN_GETC:
+  case PARSER_TOKEN_BUILTIN_READ:
+  case PARSER_TOKEN_BUILTIN_MAP_FILE:
+  case PARSER_TOKEN_BUILTIN_UNMAP_FILE:
+  case PARSER_TOKEN_BUILTIN_MEMCPY:
+  case PARSER_TOKEN_BUILTIN_MEMSET:
+  case PARSER_TOKEN_BUILTIN_MEMCMP:
+  case PARSER_TOKEN_BUILTIN_SUM:
+  case PARSER_TOKEN_BUILTIN_MIN:
+  case PARSER_TOKEN_BUILTIN_MAX:
+  case PARSER_TOKEN_BUILTIN_DOT:
   case PARSER_TOKEN_BUILTIN_NEG:
   case PARSER_TOKEN_BUILTIN_ADD:
   case PARSER_TOKEN_BUILTIN_SUB:
@@ -15,6 +15,26 @@ typedef enum ParserToken {
   PARSER_TOKEN_BUILTIN_IS_COMPTIME,
   PARSER_TOKEN_BUILTIN_STACK_ALLOC,
   PARSER_TOKEN_BUILTIN_HEAP_ALLOC,
+  PARSER_TOKEN_BUILTIN_FREE,
+  PARSER_TOKEN_BUILTIN_FFI,
+  PARSER_TOKEN_BUILTIN_SPAWN,
+  PARSER_TOKEN_BUILTIN_JOIN,
+  PARSER_TOKEN_BUILTIN_ATOMIC_LOAD,
+  PARSER_TOKEN_BUILTIN_ATOMIC_STORE,
+  PARSER_TOKEN_BUILTIN_ATOMIC_ADD,
+  PARSER_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE,
+  PARSER_TOKEN_BUILTIN_PARALLEL_FOR,
+  PARSER_TOKEN_BUILTIN_GETC,
+  PARSER_TOKEN_BUILTIN_READ,
+  PARSER_TOKEN_BUILTIN_MAP_FILE,
+  PARSER_TOKEN_BUILTIN_UNMAP_FILE,
+  PARSER_TOKEN_BUILTIN_MEMCPY,
+  PARSER_TOKEN_BUILTIN_MEMSET,
+  PARSER_TOKEN_BUILTIN_MEMCMP,
+  PARSER_TOKEN_BUILTIN_SUM,
+  PARSER_TOKEN_BUILTIN_MIN,
+  PARSER_TOKEN_BUILTIN_MAX,
+  PARSER_TOKEN_BUILTIN_DOT,
   PARSER_TOKEN_BUILTIN_NEG,
   PARSER_TOKEN_BUILTIN_ADD,
   PARSER_TOKEN_BUILTIN_SUB,
@@ -137,6 +157,8 @@ typedef struct ParserNodeVariableMetadata {
   ParserNode *type;
   ParserNode *value;
   bool isLazy;
+  // lazy and evaluated again on every read
+  bool isByName;
   bool isComptime;
 } ParserNodeVariableMetadata;
 
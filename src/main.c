@@ -1,10 +1,15 @@
 #include "compiler/ast-tree.h"
 #include "runner/runner.h"
 #include "utils/file.h"
+#include "utils/input.h"
 #include "utils/log.h"
+#include "utils/output.h"
+#include "utils/string.h"
 #include <stdio.h>
+#include <unistd.h>
 
 #ifdef PRINT_STATISTICS
+#include "utils/memory.h"
 #include "utils/time.h"
 #endif
 
@@ -43,6 +48,7 @@ static int run(const char *filePath) {
     ret = 1;
   }
   astTreeRootsDestroy(astTrees);
+  outputFlush();
 #ifdef PRINT_STATISTICS
   end = get_time();
   runTime = time_diff(end, start);
@@ -63,22 +69,80 @@ static int run(const char *filePath) {
   printf("\ntotal:     ");
   time_print(totalTime);
   printf("\n");
+#ifdef SLAB_ALLOCATOR
+  SlabStatistics slab = a404m_slab_statistics();
+  printf("slab:      %zu allocs, %zu hits, %zu frees, %zu chunks, %zu "
+         "fallbacks\n",
+         slab.allocs, slab.hits, slab.frees, slab.chunks, slab.fallbacks);
+  printf("arena:     %zu allocs, %zu resets\n", slab.arenaAllocs,
+         slab.arenaResets);
+#endif
+  HeapStatistics heap = a404m_heap_statistics();
+  printf("heap:      %zu allocs, %zu hits, %zu frees, %zu live bytes, %zu "
+         "peak bytes\n",
+         heap.allocs, heap.hits, heap.frees, heap.liveBytes, heap.peakBytes);
 #endif
 
   return ret;
 }
 
 int main(int argc, char *argv[]) {
-  fileInit();
+  static const char FLUSH_ON_NEWLINE_STR[] = "--flush-on-newline";
+  static const char OUTPUT_BUFFER_STR[] = "--output-buffer=";
+  static const size_t OUTPUT_BUFFER_STR_SIZE =
+      sizeof(OUTPUT_BUFFER_STR) / sizeof(*OUTPUT_BUFFER_STR) -
+      sizeof(*OUTPUT_BUFFER_STR);
+  static const char INPUT_BUFFER_STR[] = "--input-buffer=";
+  static const size_t INPUT_BUFFER_STR_SIZE =
+      sizeof(INPUT_BUFFER_STR) / sizeof(*INPUT_BUFFER_STR) -
+      sizeof(*INPUT_BUFFER_STR);
 
-  if (argc < 2) {
+  const char *filePath = NULL;
+  size_t outputSize = OUTPUT_DEFAULT_SIZE;
+  size_t inputSize = INPUT_DEFAULT_SIZE;
+  bool flushOnNewline = isatty(STDOUT_FILENO);
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (strEquals(arg, FLUSH_ON_NEWLINE_STR)) {
+      flushOnNewline = true;
+    } else if (strnEquals(arg, OUTPUT_BUFFER_STR, OUTPUT_BUFFER_STR_SIZE)) {
+      const char *size_begin = arg + OUTPUT_BUFFER_STR_SIZE;
+      bool success;
+      outputSize =
+          decimalToU64(size_begin, size_begin + strLength(size_begin), &success);
+      if (!success) {
+        printLog("Bad output buffer size '%s'", size_begin);
+        return 1;
+      }
+    } else if (strnEquals(arg, INPUT_BUFFER_STR, INPUT_BUFFER_STR_SIZE)) {
+      const char *size_begin = arg + INPUT_BUFFER_STR_SIZE;
+      bool success;
+      inputSize =
+          decimalToU64(size_begin, size_begin + strLength(size_begin), &success);
+      if (!success) {
+        printLog("Bad input buffer size '%s'", size_begin);
+        return 1;
+      }
+    } else if (filePath == NULL) {
+      filePath = arg;
+    }
+  }
+
+  if (filePath == NULL) {
     // compileRun("test/main.felan", "build/out", false);
     // run("test/main.felan", false);
     printLog("Too few args");
     return 1;
   }
 
-  const int ret = run(argv[1]);
+  fileInit();
+  outputInit(outputSize, flushOnNewline);
+  inputInit(inputSize);
+
+  const int ret = run(filePath);
+  inputDelete();
+  outputDelete();
   fileDelete();
   return ret;
 }
@@ -0,0 +1,978 @@
+#include "bytecode.h"
+
+#include "runner/runner.h"
+#include "utils/log.h"
+#include "utils/memory.h"
+#include <stdio.h>
+
+const char *BYTECODE_OPCODE_STRINGS[] = {
+    "BYTECODE_OPCODE_PUSH",
+    "BYTECODE_OPCODE_PUSH_LAZY",
+    "BYTECODE_OPCODE_POP",
+    "BYTECODE_OPCODE_LOAD_LOCAL",
+    "BYTECODE_OPCODE_LOAD_VARIABLE",
+    "BYTECODE_OPCODE_LOAD_LAZY",
+    "BYTECODE_OPCODE_LOAD_LOCAL_REF",
+    "BYTECODE_OPCODE_STORE_LOCAL",
+    "BYTECODE_OPCODE_STORE_VARIABLE",
+    "BYTECODE_OPCODE_STORE",
+    "BYTECODE_OPCODE_DEFINE",
+    "BYTECODE_OPCODE_DEFINE_VARIABLE",
+    "BYTECODE_OPCODE_DEFINE_LAZY",
+    "BYTECODE_OPCODE_DEREFERENCE",
+    "BYTECODE_OPCODE_ACCESS",
+    "BYTECODE_OPCODE_ACCESS_REF",
+    "BYTECODE_OPCODE_INDEX",
+    "BYTECODE_OPCODE_INDEX_REF",
+    "BYTECODE_OPCODE_JUMP",
+    "BYTECODE_OPCODE_JUMP_IF_FALSE",
+    "BYTECODE_OPCODE_JUMP_IF_FALSE_OR_POP",
+    "BYTECODE_OPCODE_JUMP_IF_TRUE_OR_POP",
+    "BYTECODE_OPCODE_CALL",
+    "BYTECODE_OPCODE_BUILTIN",
+    "BYTECODE_OPCODE_PUTC",
+    "BYTECODE_OPCODE_RETURN",
+    "BYTECODE_OPCODE_EVAL",
+    "BYTECODE_OPCODE_EVAL_REF",
+};
+
+typedef struct BytecodeLoop {
+  size_t start;
+  size_t stack_size;
+  size_t *breaks;
+  size_t breaks_size;
+} BytecodeLoop;
+
+typedef struct BytecodeCompiler {
+  BytecodeChunk *chunk;
+  size_t stack_size;
+  BytecodeLoop **loops;
+  size_t loops_size;
+} BytecodeCompiler;
+
+static bool bytecodeCompile(AstTree *expr, BytecodeCompiler *compiler);
+static bool bytecodeCompileRef(AstTree *expr, BytecodeCompiler *compiler);
+
+#ifdef PRINT_COMPILE_TREE
+void bytecodeChunkPrint(const BytecodeChunk *chunk) {
+  printf("{locals=%ld,boxed=%ld,stack_size=%ld\n", chunk->locals.size,
+         chunk->boxed.size, chunk->stack_size);
+  for (size_t i = 0; i < chunk->instructions_size; ++i) {
+    const BytecodeInstruction *instruction = &chunk->instructions[i];
+    printf("  %ld: %s %u\n", i, BYTECODE_OPCODE_STRINGS[instruction->opcode],
+           instruction->operand);
+  }
+  printf("}\n");
+}
+#endif
+
+void bytecodeChunkDelete(BytecodeChunk *chunk) {
+  free(chunk->instructions);
+  free(chunk->locals.data);
+  free(chunk->boxed.data);
+  free(chunk);
+}
+
+static BytecodeInstruction *bytecodeEmit(BytecodeCompiler *compiler,
+                                         BytecodeOpcode opcode, u32 operand) {
+  BytecodeChunk *chunk = compiler->chunk;
+  size_t instructions_size =
+      a404m_malloc_usable_size(chunk->instructions) /
+      sizeof(*chunk->instructions);
+  if (instructions_size == chunk->instructions_size) {
+    instructions_size += instructions_size / 2 + 1;
+    chunk->instructions =
+        a404m_realloc(chunk->instructions,
+                      instructions_size * sizeof(*chunk->instructions));
+  }
+  BytecodeInstruction *instruction =
+      &chunk->instructions[chunk->instructions_size++];
+  instruction->opcode = opcode;
+  instruction->operand = operand;
+  instruction->tree = NULL;
+  return instruction;
+}
+
+// keeps track of the stack depth that the emitted code leaves behind
+static void bytecodeStack(BytecodeCompiler *compiler, ssize_t diff) {
+  compiler->stack_size += diff;
+  if (compiler->stack_size > compiler->chunk->stack_size) {
+    compiler->chunk->stack_size = compiler->stack_size;
+  }
+}
+
+static void bytecodeEmitTree(BytecodeCompiler *compiler, BytecodeOpcode opcode,
+                             AstTree *tree) {
+  bytecodeEmit(compiler, opcode, 0)->tree = tree;
+  bytecodeStack(compiler, 1);
+}
+
+static ssize_t bytecodeFindLocal(BytecodeChunk *chunk,
+                                 AstTreeVariable *variable) {
+  if (variable->slot < chunk->locals.size &&
+      chunk->locals.data[variable->slot] == variable) {
+    return variable->slot;
+  }
+  return -1;
+}
+
+static bool bytecodeIsBoxed(BytecodeChunk *chunk, AstTreeVariable *variable) {
+  for (size_t i = 0; i < chunk->boxed.size; ++i) {
+    if (chunk->boxed.data[i] == variable) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void bytecodeBox(BytecodeCompiler *compiler,
+                        AstTreeVariable *variable) {
+  BytecodeChunk *chunk = compiler->chunk;
+  if (bytecodeFindLocal(chunk, variable) != -1 &&
+      !bytecodeIsBoxed(chunk, variable)) {
+    pushVariable(&chunk->boxed, variable);
+  }
+}
+
+// boxes every local that the tree-walker can see while running the tree
+static void bytecodeBoxTree(AstTree *tree, BytecodeCompiler *compiler) {
+  switch (tree->token) {
+  case AST_TREE_TOKEN_VARIABLE:
+    bytecodeBox(compiler, tree->metadata);
+    return;
+  case AST_TREE_TOKEN_VARIABLE_DEFINE: {
+    AstTreeVariable *variable = tree->metadata;
+    bytecodeBox(compiler, variable);
+    if (variable->initValue != NULL) {
+      bytecodeBoxTree(variable->initValue, compiler);
+    }
+    return;
+  }
+  case AST_TREE_TOKEN_FUNCTION_CALL: {
+    AstTreeFunctionCall *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->function, compiler);
+    for (size_t i = 0; i < metadata->parameters_size; ++i) {
+      bytecodeBoxTree(metadata->parameters[i].value, compiler);
+    }
+    return;
+  }
+  case AST_TREE_TOKEN_OPERATOR_PLUS:
+  case AST_TREE_TOKEN_OPERATOR_MINUS:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_NOT: {
+    AstTreeUnary *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->operand, compiler);
+    return;
+  }
+  case AST_TREE_TOKEN_OPERATOR_ASSIGN:
+  case AST_TREE_TOKEN_OPERATOR_SUM:
+  case AST_TREE_TOKEN_OPERATOR_SUB:
+  case AST_TREE_TOKEN_OPERATOR_MULTIPLY:
+  case AST_TREE_TOKEN_OPERATOR_DIVIDE:
+  case AST_TREE_TOKEN_OPERATOR_MODULO:
+  case AST_TREE_TOKEN_OPERATOR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_NOT_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_GREATER:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER:
+  case AST_TREE_TOKEN_OPERATOR_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_AND:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_OR: {
+    AstTreeInfix *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->left, compiler);
+    bytecodeBoxTree(metadata->right, compiler);
+    return;
+  }
+  case AST_TREE_TOKEN_KEYWORD_PUTC:
+  case AST_TREE_TOKEN_KEYWORD_COMPTIME:
+  case AST_TREE_TOKEN_OPERATOR_POINTER:
+  case AST_TREE_TOKEN_OPERATOR_ADDRESS:
+  case AST_TREE_TOKEN_OPERATOR_DEREFERENCE:
+    bytecodeBoxTree(tree->metadata, compiler);
+    return;
+  case AST_TREE_TOKEN_OPERATOR_ACCESS: {
+    AstTreeAccess *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->object, compiler);
+    return;
+  }
+  case AST_TREE_TOKEN_TYPE_ARRAY:
+  case AST_TREE_TOKEN_OPERATOR_ARRAY_ACCESS: {
+    AstTreeBracket *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->operand, compiler);
+    for (size_t i = 0; i < metadata->parameters.size; ++i) {
+      bytecodeBoxTree(metadata->parameters.data[i], compiler);
+    }
+    return;
+  }
+  case AST_TREE_TOKEN_KEYWORD_RETURN: {
+    AstTreeReturn *metadata = tree->metadata;
+    if (metadata->value != NULL) {
+      bytecodeBoxTree(metadata->value, compiler);
+    }
+    return;
+  }
+  case AST_TREE_TOKEN_KEYWORD_IF: {
+    AstTreeIf *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->condition, compiler);
+    bytecodeBoxTree(metadata->ifBody, compiler);
+    if (metadata->elseBody != NULL) {
+      bytecodeBoxTree(metadata->elseBody, compiler);
+    }
+    return;
+  }
+  case AST_TREE_TOKEN_KEYWORD_WHILE: {
+    AstTreeWhile *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->condition, compiler);
+    bytecodeBoxTree(metadata->body, compiler);
+    return;
+  }
+  case AST_TREE_TOKEN_SCOPE: {
+    AstTreeScope *metadata = tree->metadata;
+    for (size_t i = 0; i < metadata->expressions_size; ++i) {
+      bytecodeBoxTree(metadata->expressions[i], compiler);
+    }
+    return;
+  }
+  case AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT: {
+    AstTreeShapeShifterElement *metadata = tree->metadata;
+    bytecodeBoxTree(metadata->shapeShifter, compiler);
+    return;
+  }
+  case AST_TREE_TOKEN_FUNCTION:
+  case AST_TREE_TOKEN_BUILTIN_CAST:
+  case AST_TREE_TOKEN_BUILTIN_TYPE_OF:
+  case AST_TREE_TOKEN_BUILTIN_IMPORT:
+  case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
+  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+  case AST_TREE_TOKEN_BUILTIN_NEG:
+  case AST_TREE_TOKEN_BUILTIN_ADD:
+  case AST_TREE_TOKEN_BUILTIN_SUB:
+  case AST_TREE_TOKEN_BUILTIN_MUL:
+  case AST_TREE_TOKEN_BUILTIN_DIV:
+  case AST_TREE_TOKEN_BUILTIN_MOD:
+  case AST_TREE_TOKEN_BUILTIN_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_NOT_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_GREATER:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER:
+  case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
+  case AST_TREE_TOKEN_KEYWORD_BREAK:
+  case AST_TREE_TOKEN_KEYWORD_CONTINUE:
+  case AST_TREE_TOKEN_KEYWORD_STRUCT:
+  case AST_TREE_TOKEN_TYPE_FUNCTION:
+  case AST_TREE_TOKEN_TYPE_TYPE:
+  case AST_TREE_TOKEN_TYPE_VOID:
+  case AST_TREE_TOKEN_TYPE_I8:
+  case AST_TREE_TOKEN_TYPE_U8:
+  case AST_TREE_TOKEN_TYPE_I16:
+  case AST_TREE_TOKEN_TYPE_U16:
+  case AST_TREE_TOKEN_TYPE_I32:
+  case AST_TREE_TOKEN_TYPE_U32:
+  case AST_TREE_TOKEN_TYPE_I64:
+  case AST_TREE_TOKEN_TYPE_U64:
+#ifdef FLOAT_16_SUPPORT
+  case AST_TREE_TOKEN_TYPE_F16:
+#endif
+  case AST_TREE_TOKEN_TYPE_F32:
+  case AST_TREE_TOKEN_TYPE_F64:
+  case AST_TREE_TOKEN_TYPE_F128:
+  case AST_TREE_TOKEN_TYPE_CODE:
+  case AST_TREE_TOKEN_TYPE_NAMESPACE:
+  case AST_TREE_TOKEN_TYPE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_TYPE_BOOL:
+  case AST_TREE_TOKEN_VALUE_VOID:
+  case AST_TREE_TOKEN_VALUE_NULL:
+  case AST_TREE_TOKEN_VALUE_UNDEFINED:
+  case AST_TREE_TOKEN_VALUE_NAMESPACE:
+  case AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_VALUE_INT:
+  case AST_TREE_TOKEN_VALUE_FLOAT:
+  case AST_TREE_TOKEN_VALUE_BOOL:
+  case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
+    return;
+  case AST_TREE_TOKEN_NONE:
+  }
+  UNREACHABLE;
+}
+
+static void bytecodeEmitEval(BytecodeCompiler *compiler, BytecodeOpcode opcode,
+                             AstTree *tree) {
+  bytecodeBoxTree(tree, compiler);
+  bytecodeEmitTree(compiler, opcode, tree);
+}
+
+static size_t bytecodeLoopBreak(BytecodeLoop *loop) {
+  size_t breaks_size =
+      a404m_malloc_usable_size(loop->breaks) / sizeof(*loop->breaks);
+  if (breaks_size == loop->breaks_size) {
+    breaks_size += breaks_size / 2 + 1;
+    loop->breaks =
+        a404m_realloc(loop->breaks, breaks_size * sizeof(*loop->breaks));
+  }
+  return loop->breaks_size++;
+}
+
+static bool bytecodeCompileLoopControl(AstTree *expr,
+                                       BytecodeCompiler *compiler) {
+  AstTreeLoopControl *metadata = expr->metadata;
+  if (metadata->count == 0 || metadata->count > compiler->loops_size) {
+    printError(expr->str_begin, expr->str_end, "Bad loop control");
+    return false;
+  }
+  BytecodeLoop *loop = compiler->loops[compiler->loops_size - metadata->count];
+  if (compiler->stack_size != loop->stack_size) {
+    bytecodeEmit(compiler, BYTECODE_OPCODE_POP,
+                 compiler->stack_size - loop->stack_size);
+  }
+  if (expr->token == AST_TREE_TOKEN_KEYWORD_BREAK) {
+    const size_t index = bytecodeLoopBreak(loop);
+    loop->breaks[index] = compiler->chunk->instructions_size;
+    bytecodeEmit(compiler, BYTECODE_OPCODE_JUMP, 0);
+  } else {
+    bytecodeEmit(compiler, BYTECODE_OPCODE_JUMP, loop->start);
+  }
+  // unreachable but keeps the stack accounting of the expression
+  bytecodeStack(compiler, 1);
+  return true;
+}
+
+static bool bytecodeCompileWhile(AstTree *expr, BytecodeCompiler *compiler) {
+  AstTreeWhile *metadata = expr->metadata;
+  BytecodeLoop loop = {
+      .start = compiler->chunk->instructions_size,
+      .stack_size = compiler->stack_size,
+      .breaks = NULL,
+      .breaks_size = 0,
+  };
+
+  BytecodeLoop *loops[compiler->loops_size + 1];
+  for (size_t i = 0; i < compiler->loops_size; ++i) {
+    loops[i] = compiler->loops[i];
+  }
+  loops[compiler->loops_size] = &loop;
+
+  BytecodeCompiler inner = *compiler;
+  inner.loops = loops;
+  inner.loops_size = compiler->loops_size + 1;
+
+  bool ret = false;
+  if (!bytecodeCompile(metadata->condition, &inner)) {
+    goto RETURN;
+  }
+  const size_t exitJump = inner.chunk->instructions_size;
+  bytecodeEmit(&inner, BYTECODE_OPCODE_JUMP_IF_FALSE, 0);
+  bytecodeStack(&inner, -1);
+
+  if (!bytecodeCompile(metadata->body, &inner)) {
+    goto RETURN;
+  }
+  bytecodeEmit(&inner, BYTECODE_OPCODE_POP, 1);
+  bytecodeStack(&inner, -1);
+  bytecodeEmit(&inner, BYTECODE_OPCODE_JUMP, loop.start);
+
+  const size_t end = inner.chunk->instructions_size;
+  inner.chunk->instructions[exitJump].operand = end;
+  for (size_t i = 0; i < loop.breaks_size; ++i) {
+    inner.chunk->instructions[loop.breaks[i]].operand = end;
+  }
+  compiler->stack_size = inner.stack_size;
+  bytecodeEmitTree(compiler, BYTECODE_OPCODE_PUSH, &AST_TREE_VOID_VALUE);
+  ret = true;
+
+RETURN:
+  free(loop.breaks);
+  return ret;
+}
+
+static bool bytecodeCompileIf(AstTree *expr, BytecodeCompiler *compiler) {
+  AstTreeIf *metadata = expr->metadata;
+  if (!bytecodeCompile(metadata->condition, compiler)) {
+    return false;
+  }
+  const size_t elseJump = compiler->chunk->instructions_size;
+  bytecodeEmit(compiler, BYTECODE_OPCODE_JUMP_IF_FALSE, 0);
+  bytecodeStack(compiler, -1);
+
+  if (!bytecodeCompile(metadata->ifBody, compiler)) {
+    return false;
+  }
+  bytecodeStack(compiler, -1);
+  const size_t endJump = compiler->chunk->instructions_size;
+  bytecodeEmit(compiler, BYTECODE_OPCODE_JUMP, 0);
+
+  compiler->chunk->instructions[elseJump].operand =
+      compiler->chunk->instructions_size;
+  if (metadata->elseBody != NULL) {
+    if (!bytecodeCompile(metadata->elseBody, compiler)) {
+      return false;
+    }
+  } else {
+    bytecodeEmitTree(compiler, BYTECODE_OPCODE_PUSH, &AST_TREE_VOID_VALUE);
+  }
+  compiler->chunk->instructions[endJump].operand =
+      compiler->chunk->instructions_size;
+  return true;
+}
+
+// the left value is the result when it decides it alone
+static bool bytecodeCompileShortCircuit(AstTreeInfix *metadata,
+                                        AstTreeToken token,
+                                        BytecodeCompiler *compiler) {
+  if (!bytecodeCompile(metadata->left, compiler)) {
+    return false;
+  }
+  const size_t endJump = compiler->chunk->instructions_size;
+  bytecodeEmit(compiler,
+               token == AST_TREE_TOKEN_OPERATOR_LOGICAL_AND
+                   ? BYTECODE_OPCODE_JUMP_IF_FALSE_OR_POP
+                   : BYTECODE_OPCODE_JUMP_IF_TRUE_OR_POP,
+               0);
+  bytecodeStack(compiler, -1);
+
+  if (!bytecodeCompile(metadata->right, compiler)) {
+    return false;
+  }
+  compiler->chunk->instructions[endJump].operand =
+      compiler->chunk->instructions_size;
+  return true;
+}
+
+static bool bytecodeCompileScope(AstTreeScope *scope,
+                                 BytecodeCompiler *compiler) {
+  if (scope->expressions_size == 0) {
+    bytecodeEmitTree(compiler, BYTECODE_OPCODE_PUSH, &AST_TREE_VOID_VALUE);
+    return true;
+  }
+  for (size_t i = 0; i < scope->expressions_size; ++i) {
+    if (!bytecodeCompile(scope->expressions[i], compiler)) {
+      return false;
+    }
+    if (i + 1 != scope->expressions_size) {
+      bytecodeEmit(compiler, BYTECODE_OPCODE_POP, 1);
+      bytecodeStack(compiler, -1);
+    }
+  }
+  return true;
+}
+
+static bool bytecodeCompileCall(AstTreeFunction *function, AstTree **arguments,
+                                size_t arguments_size,
+                                BytecodeCompiler *compiler) {
+  for (size_t i = 0; i < arguments_size; ++i) {
+    AstTreeVariable *arg = function->arguments.data[i];
+    if (arg->isLazy) {
+      bytecodeBoxTree(arguments[i], compiler);
+      bytecodeEmit(compiler, BYTECODE_OPCODE_PUSH_LAZY, arg->isByName)->tree =
+          arguments[i];
+      bytecodeStack(compiler, 1);
+    } else if (!bytecodeCompile(arguments[i], compiler)) {
+      return false;
+    }
+  }
+  bytecodeEmit(compiler, BYTECODE_OPCODE_CALL, arguments_size)->function =
+      function;
+  bytecodeStack(compiler, 1 - (ssize_t)arguments_size);
+  return true;
+}
+
+static bool bytecodeCompileBuiltin(AstTreeToken builtin, AstTree **arguments,
+                                   size_t arguments_size,
+                                   BytecodeCompiler *compiler) {
+  for (size_t i = 0; i < arguments_size; ++i) {
+    if (runnerIsMemoryDestination(builtin, i, arguments[i])) {
+      if (!bytecodeCompileRef(arguments[i], compiler)) {
+        return false;
+      }
+    } else if (!bytecodeCompile(arguments[i], compiler)) {
+      return false;
+    }
+  }
+  bytecodeEmit(compiler, BYTECODE_OPCODE_BUILTIN, arguments_size)->builtin =
+      builtin;
+  bytecodeStack(compiler, 1 - (ssize_t)arguments_size);
+  return true;
+}
+
+static AstTreeFunction *bytecodeStaticCallee(AstTree *callee) {
+  if (callee->token == AST_TREE_TOKEN_VARIABLE) {
+    AstTreeVariable *variable = callee->metadata;
+    if (variable->isConst && variable->value != NULL &&
+        variable->value->token == AST_TREE_TOKEN_FUNCTION) {
+      return variable->value->metadata;
+    }
+  } else if (callee->token == AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT) {
+    AstTreeShapeShifterElement *metadata = callee->metadata;
+    if (metadata->shapeShifter->token == AST_TREE_TOKEN_VARIABLE) {
+      AstTreeVariable *variable = metadata->shapeShifter->metadata;
+      if (variable->value != NULL &&
+          variable->value->token == AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER) {
+        AstTreeShapeShifter *shapeShifter = variable->value->metadata;
+        return shapeShifter->generateds.functions[metadata->index];
+      }
+    }
+  }
+  return NULL;
+}
+
+static bool bytecodeCompileFunctionCall(AstTree *expr,
+                                        BytecodeCompiler *compiler) {
+  AstTreeFunctionCall *metadata = expr->metadata;
+  AstTree *callee = metadata->function;
+
+  if (callee->token == AST_TREE_TOKEN_BUILTIN_TYPE_OF) {
+    // the type of the argument is known statically
+    bytecodeEmit(compiler, BYTECODE_OPCODE_PUSH, 0)->tree =
+        metadata->parameters[0].value->type;
+    bytecodeStack(compiler, 1);
+    return true;
+  } else if (callee->token >= AST_TREE_TOKEN_BUILTIN_BEGIN &&
+             callee->token <= AST_TREE_TOKEN_BUILTIN_END) {
+    AstTree *arguments[metadata->parameters_size + 1];
+    for (size_t i = 0; i < metadata->parameters_size; ++i) {
+      arguments[i] = metadata->parameters[i].value;
+    }
+    return bytecodeCompileBuiltin(callee->token, arguments,
+                                  metadata->parameters_size, compiler);
+  }
+
+  AstTreeFunction *function = bytecodeStaticCallee(callee);
+  if (function == NULL) {
+    // dynamic callees are rare, let the tree walker handle them
+    bytecodeEmitEval(compiler, BYTECODE_OPCODE_EVAL, expr);
+    return true;
+  }
+
+  AstTree *arguments[metadata->parameters_size + 1];
+  for (size_t i = 0; i < metadata->parameters_size; ++i) {
+    arguments[i] = metadata->parameters[i].value;
+  }
+  return bytecodeCompileCall(function, arguments, metadata->parameters_size,
+                             compiler);
+}
+
+static bool bytecodeCompileVariable(AstTree *expr, BytecodeCompiler *compiler) {
+  AstTreeVariable *variable = expr->metadata;
+  if (variable->isLazy) {
+    bytecodeBox(compiler, variable);
+    bytecodeEmit(compiler, BYTECODE_OPCODE_LOAD_LAZY, 0)->variable = variable;
+  } else {
+    const ssize_t slot = bytecodeFindLocal(compiler->chunk, variable);
+    if (slot == -1) {
+      bytecodeEmit(compiler, BYTECODE_OPCODE_LOAD_VARIABLE, 0)->variable =
+          variable;
+    } else {
+      bytecodeEmit(compiler, BYTECODE_OPCODE_LOAD_LOCAL, slot);
+    }
+  }
+  bytecodeStack(compiler, 1);
+  return true;
+}
+
+static bool bytecodeCompileAssign(AstTree *expr, BytecodeCompiler *compiler) {
+  AstTreeInfix *metadata = expr->metadata;
+  if (metadata->left->token == AST_TREE_TOKEN_VARIABLE) {
+    const ssize_t slot =
+        bytecodeFindLocal(compiler->chunk, metadata->left->metadata);
+    if (slot != -1) {
+      if (!bytecodeCompile(metadata->right, compiler)) {
+        return false;
+      }
+      bytecodeEmit(compiler, BYTECODE_OPCODE_STORE_LOCAL, slot);
+      return true;
+    }
+  }
+  if (!bytecodeCompileRef(metadata->left, compiler) ||
+      !bytecodeCompile(metadata->right, compiler)) {
+    return false;
+  }
+  bytecodeEmit(compiler, BYTECODE_OPCODE_STORE, 0);
+  bytecodeStack(compiler, -1);
+  return true;
+}
+
+static bool bytecodeCompileVariableDefine(AstTree *expr,
+                                          BytecodeCompiler *compiler) {
+  AstTreeVariable *variable = expr->metadata;
+  BytecodeChunk *chunk = compiler->chunk;
+  ssize_t slot = bytecodeFindLocal(chunk, variable);
+  if (slot == -1) {
+    if (variable->slot < chunk->locals.size &&
+        chunk->locals.data[variable->slot] == NULL) {
+      chunk->locals.data[variable->slot] = variable;
+    } else {
+      // not seen by the type checker as a local of this function
+      variable->slot = chunk->locals.size;
+      pushVariable(&chunk->locals, variable);
+    }
+    slot = variable->slot;
+  }
+  if (variable->isLazy) {
+    bytecodeBox(compiler, variable);
+    bytecodeEmit(compiler, BYTECODE_OPCODE_DEFINE_LAZY, 0)->variable = variable;
+    bytecodeStack(compiler, 1);
+  } else {
+    if (!bytecodeCompile(variable->initValue, compiler)) {
+      return false;
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_DEFINE, slot);
+  }
+  return true;
+}
+
+static bool bytecodeCompileRef(AstTree *expr, BytecodeCompiler *compiler) {
+  switch (expr->token) {
+  case AST_TREE_TOKEN_VARIABLE: {
+    AstTreeVariable *variable = expr->metadata;
+    const ssize_t slot = bytecodeFindLocal(compiler->chunk, variable);
+    if (slot != -1 && !variable->isLazy) {
+      // members and elements of locals are reached through a view of the
+      // frame slot, the tree is kept in case the local gets boxed
+      bytecodeEmit(compiler, BYTECODE_OPCODE_LOAD_LOCAL_REF, slot)->tree = expr;
+      bytecodeStack(compiler, 1);
+      compiler->chunk->viewed = true;
+      return true;
+    }
+    bytecodeBox(compiler, variable);
+    bytecodeEmitTree(compiler, BYTECODE_OPCODE_PUSH, expr);
+    return true;
+  }
+  case AST_TREE_TOKEN_OPERATOR_DEREFERENCE:
+    return bytecodeCompile(expr->metadata, compiler);
+  case AST_TREE_TOKEN_OPERATOR_ACCESS: {
+    AstTreeAccess *metadata = expr->metadata;
+    if (!bytecodeCompileRef(metadata->object, compiler)) {
+      return false;
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_ACCESS_REF, metadata->member.index);
+    return true;
+  }
+  case AST_TREE_TOKEN_OPERATOR_ARRAY_ACCESS: {
+    AstTreeBracket *metadata = expr->metadata;
+    if (metadata->parameters.size != 1) {
+      UNREACHABLE;
+    }
+    if (!bytecodeCompileRef(metadata->operand, compiler) ||
+        !bytecodeCompile(metadata->parameters.data[0], compiler)) {
+      return false;
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_INDEX_REF, 0);
+    bytecodeStack(compiler, -1);
+    return true;
+  }
+  default:
+    bytecodeEmitEval(compiler, BYTECODE_OPCODE_EVAL_REF, expr);
+    return true;
+  }
+}
+
+static bool bytecodeCompile(AstTree *expr, BytecodeCompiler *compiler) {
+  switch (expr->token) {
+  case AST_TREE_TOKEN_KEYWORD_PUTC:
+    if (!bytecodeCompile(expr->metadata, compiler)) {
+      return false;
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_PUTC, 0);
+    return true;
+  case AST_TREE_TOKEN_FUNCTION_CALL:
+    return bytecodeCompileFunctionCall(expr, compiler);
+  case AST_TREE_TOKEN_OPERATOR_ASSIGN:
+    return bytecodeCompileAssign(expr, compiler);
+  case AST_TREE_TOKEN_KEYWORD_RETURN: {
+    AstTreeReturn *metadata = expr->metadata;
+    if (metadata->value != NULL) {
+      if (!bytecodeCompile(metadata->value, compiler)) {
+        return false;
+      }
+    } else {
+      bytecodeEmitTree(compiler, BYTECODE_OPCODE_PUSH, &AST_TREE_VOID_VALUE);
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_RETURN, 0);
+    return true;
+  }
+  case AST_TREE_TOKEN_VARIABLE_DEFINE:
+    return bytecodeCompileVariableDefine(expr, compiler);
+  case AST_TREE_TOKEN_KEYWORD_IF:
+    return bytecodeCompileIf(expr, compiler);
+  case AST_TREE_TOKEN_KEYWORD_WHILE:
+    return bytecodeCompileWhile(expr, compiler);
+  case AST_TREE_TOKEN_KEYWORD_COMPTIME:
+    return bytecodeCompile(expr->metadata, compiler);
+  case AST_TREE_TOKEN_SCOPE:
+    return bytecodeCompileScope(expr->metadata, compiler);
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_NOT:
+  case AST_TREE_TOKEN_OPERATOR_MINUS:
+  case AST_TREE_TOKEN_OPERATOR_PLUS: {
+    AstTreeUnary *metadata = expr->metadata;
+    AstTree *arguments[] = {
+        metadata->operand,
+    };
+    if (metadata->builtin != AST_TREE_TOKEN_NONE) {
+      return bytecodeCompileBuiltin(metadata->builtin, arguments, 1, compiler);
+    }
+    return bytecodeCompileCall(metadata->function->value->metadata, arguments,
+                               1, compiler);
+  }
+  case AST_TREE_TOKEN_OPERATOR_SUM:
+  case AST_TREE_TOKEN_OPERATOR_SUB:
+  case AST_TREE_TOKEN_OPERATOR_MULTIPLY:
+  case AST_TREE_TOKEN_OPERATOR_DIVIDE:
+  case AST_TREE_TOKEN_OPERATOR_MODULO:
+  case AST_TREE_TOKEN_OPERATOR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_NOT_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_GREATER:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER:
+  case AST_TREE_TOKEN_OPERATOR_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_SMALLER_OR_EQUAL:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_AND:
+  case AST_TREE_TOKEN_OPERATOR_LOGICAL_OR: {
+    AstTreeInfix *metadata = expr->metadata;
+    if (metadata->builtin == expr->token) {
+      return bytecodeCompileShortCircuit(metadata, expr->token, compiler);
+    }
+    AstTree *arguments[] = {
+        metadata->left,
+        metadata->right,
+    };
+    if (metadata->builtin != AST_TREE_TOKEN_NONE) {
+      return bytecodeCompileBuiltin(metadata->builtin, arguments, 2, compiler);
+    }
+    return bytecodeCompileCall(metadata->function->value->metadata, arguments,
+                               2, compiler);
+  }
+  case AST_TREE_TOKEN_TYPE_TYPE:
+  case AST_TREE_TOKEN_TYPE_FUNCTION:
+  case AST_TREE_TOKEN_TYPE_VOID:
+  case AST_TREE_TOKEN_TYPE_BOOL:
+  case AST_TREE_TOKEN_TYPE_I8:
+  case AST_TREE_TOKEN_TYPE_U8:
+  case AST_TREE_TOKEN_TYPE_I16:
+  case AST_TREE_TOKEN_TYPE_U16:
+  case AST_TREE_TOKEN_TYPE_I32:
+  case AST_TREE_TOKEN_TYPE_U32:
+  case AST_TREE_TOKEN_TYPE_I64:
+  case AST_TREE_TOKEN_TYPE_U64:
+#ifdef FLOAT_16_SUPPORT
+  case AST_TREE_TOKEN_TYPE_F16:
+#endif
+  case AST_TREE_TOKEN_TYPE_F32:
+  case AST_TREE_TOKEN_TYPE_F64:
+  case AST_TREE_TOKEN_TYPE_F128:
+  case AST_TREE_TOKEN_TYPE_CODE:
+  case AST_TREE_TOKEN_TYPE_NAMESPACE:
+  case AST_TREE_TOKEN_TYPE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_VALUE_NULL:
+  case AST_TREE_TOKEN_VALUE_UNDEFINED:
+  case AST_TREE_TOKEN_VALUE_VOID:
+  case AST_TREE_TOKEN_VALUE_NAMESPACE:
+  case AST_TREE_TOKEN_VALUE_INT:
+  case AST_TREE_TOKEN_VALUE_BOOL:
+  case AST_TREE_TOKEN_VALUE_FLOAT:
+  case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+  case AST_TREE_TOKEN_THUNK:
+  case AST_TREE_TOKEN_FUNCTION:
+  case AST_TREE_TOKEN_TYPE_ARRAY:
+  case AST_TREE_TOKEN_BUILTIN_CAST:
+  case AST_TREE_TOKEN_BUILTIN_TYPE_OF:
+  case AST_TREE_TOKEN_BUILTIN_IMPORT:
+  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+  case AST_TREE_TOKEN_BUILTIN_NEG:
+  case AST_TREE_TOKEN_BUILTIN_ADD:
+  case AST_TREE_TOKEN_BUILTIN_SUB:
+  case AST_TREE_TOKEN_BUILTIN_MUL:
+  case AST_TREE_TOKEN_BUILTIN_DIV:
+  case AST_TREE_TOKEN_BUILTIN_MOD:
+  case AST_TREE_TOKEN_BUILTIN_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_NOT_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_GREATER:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER:
+  case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
+    bytecodeEmitTree(compiler, BYTECODE_OPCODE_PUSH, expr);
+    return true;
+  case AST_TREE_TOKEN_OPERATOR_ADDRESS: {
+    AstTreeSingleChild *metadata = expr->metadata;
+    if (metadata->token != AST_TREE_TOKEN_VARIABLE) {
+      UNREACHABLE;
+    }
+    bytecodeBox(compiler, metadata->metadata);
+    bytecodeEmitTree(compiler, BYTECODE_OPCODE_PUSH, metadata);
+    return true;
+  }
+  case AST_TREE_TOKEN_OPERATOR_DEREFERENCE:
+    if (!bytecodeCompile(expr->metadata, compiler)) {
+      return false;
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_DEREFERENCE, 0);
+    return true;
+  case AST_TREE_TOKEN_VARIABLE:
+    return bytecodeCompileVariable(expr, compiler);
+  case AST_TREE_TOKEN_OPERATOR_ACCESS: {
+    AstTreeAccess *metadata = expr->metadata;
+    if (!bytecodeCompileRef(metadata->object, compiler)) {
+      return false;
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_ACCESS, metadata->member.index);
+    return true;
+  }
+  case AST_TREE_TOKEN_OPERATOR_ARRAY_ACCESS: {
+    AstTreeBracket *metadata = expr->metadata;
+    if (metadata->parameters.size != 1) {
+      UNREACHABLE;
+    }
+    if (!bytecodeCompileRef(metadata->operand, compiler) ||
+        !bytecodeCompile(metadata->parameters.data[0], compiler)) {
+      return false;
+    }
+    bytecodeEmit(compiler, BYTECODE_OPCODE_INDEX, 0);
+    bytecodeStack(compiler, -1);
+    return true;
+  }
+  case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME:
+  case AST_TREE_TOKEN_KEYWORD_STRUCT:
+  case AST_TREE_TOKEN_OPERATOR_POINTER:
+  case AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT:
+    bytecodeEmitEval(compiler, BYTECODE_OPCODE_EVAL, expr);
+    return true;
+  case AST_TREE_TOKEN_KEYWORD_BREAK:
+  case AST_TREE_TOKEN_KEYWORD_CONTINUE:
+    return bytecodeCompileLoopControl(expr, compiler);
+  case AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER:
+  case AST_TREE_TOKEN_NONE:
+  }
+  printError(expr->str_begin, expr->str_end, "Bad token %s",
+             AST_TREE_TOKEN_STRINGS[expr->token]);
+  return false;
+}
+
+// boxed locals are only known after the whole body is lowered
+static void bytecodeRelocateBoxed(BytecodeChunk *chunk) {
+  for (size_t i = 0; i < chunk->instructions_size; ++i) {
+    BytecodeInstruction *instruction = &chunk->instructions[i];
+    BytecodeOpcode opcode;
+    switch (instruction->opcode) {
+    case BYTECODE_OPCODE_LOAD_LOCAL_REF:
+      // boxed locals are referenced by their variable like the others
+      if (bytecodeIsBoxed(chunk, chunk->locals.data[instruction->operand])) {
+        instruction->opcode = BYTECODE_OPCODE_PUSH;
+        instruction->operand = 0;
+      }
+      continue;
+    case BYTECODE_OPCODE_LOAD_LOCAL:
+      opcode = BYTECODE_OPCODE_LOAD_VARIABLE;
+      break;
+    case BYTECODE_OPCODE_STORE_LOCAL:
+      opcode = BYTECODE_OPCODE_STORE_VARIABLE;
+      break;
+    case BYTECODE_OPCODE_DEFINE:
+      opcode = BYTECODE_OPCODE_DEFINE_VARIABLE;
+      break;
+    default:
+      continue;
+    }
+    AstTreeVariable *variable = chunk->locals.data[instruction->operand];
+    if (bytecodeIsBoxed(chunk, variable)) {
+      instruction->opcode = opcode;
+      instruction->operand = 0;
+      instruction->variable = variable;
+    }
+  }
+}
+
+BytecodeChunk *bytecodeCompileFunction(AstTreeFunction *function) {
+  BytecodeChunk *chunk = a404m_malloc(sizeof(*chunk));
+  chunk->instructions = NULL;
+  chunk->instructions_size = 0;
+  chunk->locals.size = function->slots_size;
+  chunk->locals.data =
+      a404m_malloc(chunk->locals.size * sizeof(*chunk->locals.data));
+  chunk->boxed.data = NULL;
+  chunk->boxed.size = 0;
+  chunk->viewed = false;
+  chunk->stack_size = 0;
+
+  for (size_t i = 0; i < chunk->locals.size; ++i) {
+    chunk->locals.data[i] = NULL;
+  }
+  for (size_t i = 0; i < function->arguments.size; ++i) {
+    AstTreeVariable *argument = function->arguments.data[i];
+    if (argument->slot != i || i >= chunk->locals.size) {
+      printError(argument->name_begin, argument->name_end,
+                 "Argument has no slot");
+      bytecodeChunkDelete(chunk);
+      return NULL;
+    }
+    chunk->locals.data[i] = argument;
+  }
+
+  BytecodeCompiler compiler = {
+      .chunk = chunk,
+      .stack_size = 0,
+      .loops = NULL,
+      .loops_size = 0,
+  };
+
+  for (size_t i = 0; i < function->scope.expressions_size; ++i) {
+    if (!bytecodeCompile(function->scope.expressions[i], &compiler)) {
+      bytecodeChunkDelete(chunk);
+      return NULL;
+    }
+    bytecodeEmit(&compiler, BYTECODE_OPCODE_POP, 1);
+    bytecodeStack(&compiler, -1);
+  }
+  bytecodeEmitTree(&compiler, BYTECODE_OPCODE_PUSH, &AST_TREE_VOID_VALUE);
+  bytecodeEmit(&compiler, BYTECODE_OPCODE_RETURN, 0);
+
+  bytecodeRelocateBoxed(chunk);
+
+#ifdef PRINT_COMPILE_TREE
+  bytecodeChunkPrint(chunk);
+#endif
+
+  return chunk;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "compiler/ast-tree.h"
+
+typedef enum BytecodeOpcode {
+  BYTECODE_OPCODE_PUSH,
+  BYTECODE_OPCODE_PUSH_LAZY,
+  BYTECODE_OPCODE_POP,
+  BYTECODE_OPCODE_LOAD_LOCAL,
+  BYTECODE_OPCODE_LOAD_VARIABLE,
+  BYTECODE_OPCODE_LOAD_LAZY,
+  BYTECODE_OPCODE_LOAD_LOCAL_REF,
+  BYTECODE_OPCODE_STORE_LOCAL,
+  BYTECODE_OPCODE_STORE_VARIABLE,
+  BYTECODE_OPCODE_STORE,
+  BYTECODE_OPCODE_DEFINE,
+  BYTECODE_OPCODE_DEFINE_VARIABLE,
+  BYTECODE_OPCODE_DEFINE_LAZY,
+  BYTECODE_OPCODE_DEREFERENCE,
+  BYTECODE_OPCODE_ACCESS,
+  BYTECODE_OPCODE_ACCESS_REF,
+  BYTECODE_OPCODE_INDEX,
+  BYTECODE_OPCODE_INDEX_REF,
+  BYTECODE_OPCODE_JUMP,
+  BYTECODE_OPCODE_JUMP_IF_FALSE,
+  BYTECODE_OPCODE_JUMP_IF_FALSE_OR_POP,
+  BYTECODE_OPCODE_JUMP_IF_TRUE_OR_POP,
+  BYTECODE_OPCODE_CALL,
+  BYTECODE_OPCODE_BUILTIN,
+  BYTECODE_OPCODE_PUTC,
+  BYTECODE_OPCODE_RETURN,
+  BYTECODE_OPCODE_EVAL,
+  BYTECODE_OPCODE_EVAL_REF,
+} BytecodeOpcode;
+
+extern const char *BYTECODE_OPCODE_STRINGS[];
+
+typedef struct BytecodeInstruction {
+  BytecodeOpcode opcode;
+  // slot, jump target, argument count, member index, pop count or whether a
+  // lazy argument is by name
+  u32 operand;
+  union {
+    AstTree *tree;
+    AstTreeVariable *variable;
+    AstTreeFunction *function;
+    AstTreeToken builtin;
+  };
+} BytecodeInstruction;
+
+typedef struct BytecodeChunk {
+  BytecodeInstruction *instructions;
+  size_t instructions_size;
+  // indexed by frame slot, arguments come first so they can be bound by index
+  AstTreeVariables locals;
+  // locals that are pointed to, lazy or seen by the tree-walker, they keep
+  // their value in the variable instead of the frame
+  AstTreeVariables boxed;
+  // whether member and element accesses of locals need views of the frame
+  bool viewed;
+  size_t stack_size;
+} BytecodeChunk;
+
+#ifdef PRINT_COMPILE_TREE
+void bytecodeChunkPrint(const BytecodeChunk *chunk);
+#endif
+
+void bytecodeChunkDelete(BytecodeChunk *chunk);
+
+BytecodeChunk *bytecodeCompileFunction(AstTreeFunction *function);
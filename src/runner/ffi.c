@@ -0,0 +1,344 @@
+#include "ffi.h"
+
+#include "runner/runner.h"
+#include "utils/log.h"
+#include "utils/memory.h"
+#include "utils/output.h"
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// x86-64 SysV and AAPCS64 pass integers and floats in separate registers in
+// the order they come, so any native function whose arguments fit in the
+// registers can be called as one that takes all of them
+#define FFI_INT_ARGUMENTS 6
+#define FFI_FLOAT_ARGUMENTS 8
+
+#define FFI_PARAMETERS                                                         \
+  u64, u64, u64, u64, u64, u64, f64, f64, f64, f64, f64, f64, f64, f64
+
+typedef u64 (*FfiIntFunction)(FFI_PARAMETERS);
+typedef f64 (*FfiF64Function)(FFI_PARAMETERS);
+typedef f32 (*FfiF32Function)(FFI_PARAMETERS);
+
+typedef struct FfiSymbol {
+  char *library;
+  char *name;
+  void *handle;
+  void *symbol;
+} FfiSymbol;
+
+static struct {
+  FfiSymbol *data;
+  size_t size;
+} FFI_SYMBOLS = {
+    .data = NULL,
+    .size = 0,
+};
+// threads of @spawn share the symbols
+static pthread_mutex_t FFI_SYMBOLS_MUTEX = PTHREAD_MUTEX_INITIALIZER;
+
+static char *ffiString(const AstTreeRawValue *raw) {
+  char *str = a404m_malloc(raw->size + 1);
+  memcpy(str, raw->data, raw->size);
+  str[raw->size] = '\0';
+  return str;
+}
+
+static bool ffiStringEquals(const char *str, const AstTreeRawValue *raw) {
+  return strncmp(str, (const char *)raw->data, raw->size) == 0 &&
+         str[raw->size] == '\0';
+}
+
+static void *ffiSymbolLookup(const AstTreeRawValue *library_raw,
+                             const AstTreeRawValue *name_raw) {
+  pthread_mutex_lock(&FFI_SYMBOLS_MUTEX);
+  for (size_t i = 0; i < FFI_SYMBOLS.size; ++i) {
+    FfiSymbol *symbol = &FFI_SYMBOLS.data[i];
+    if (ffiStringEquals(symbol->library, library_raw) &&
+        ffiStringEquals(symbol->name, name_raw)) {
+      pthread_mutex_unlock(&FFI_SYMBOLS_MUTEX);
+      return symbol->symbol;
+    }
+  }
+
+  char *library = ffiString(library_raw);
+  char *name = ffiString(name_raw);
+
+  // an empty library is the program itself and what it is linked with
+  void *handle = dlopen(library[0] == '\0' ? NULL : library, RTLD_LAZY);
+  // wrong names are mistakes of the program, not of the runner
+  if (handle == NULL) {
+    printLog("Can't open library '%s': %s", library, dlerror());
+    exit(1);
+  }
+  void *function = dlsym(handle, name);
+  if (function == NULL) {
+    printLog("Can't find '%s' in '%s': %s", name, library, dlerror());
+    exit(1);
+  }
+
+  size_t capacity = a404m_malloc_usable_size(FFI_SYMBOLS.data) /
+                    sizeof(*FFI_SYMBOLS.data);
+  if (capacity == FFI_SYMBOLS.size) {
+    capacity += capacity / 2 + 1;
+    FFI_SYMBOLS.data = a404m_realloc(FFI_SYMBOLS.data,
+                                     capacity * sizeof(*FFI_SYMBOLS.data));
+  }
+  FFI_SYMBOLS.data[FFI_SYMBOLS.size++] = (FfiSymbol){
+      .library = library,
+      .name = name,
+      .handle = handle,
+      .symbol = function,
+  };
+  pthread_mutex_unlock(&FFI_SYMBOLS_MUTEX);
+  return function;
+}
+
+// string literals never change and the views of one all have the same bytes,
+// so the bytes stand for the call site
+static bool ffiIsLiteral(AstTree *tree) {
+  return tree->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED &&
+         ((AstTreeBracket *)tree->type->metadata)->parameters.size != 0;
+}
+
+#define FFI_CACHE_SIZE 64
+
+typedef struct FfiCacheEntry {
+  const u8 *library;
+  const u8 *name;
+  void *symbol;
+} FfiCacheEntry;
+
+// symbols of literal names by the address of their bytes, it takes no lock
+static _Thread_local FfiCacheEntry FFI_CACHE[FFI_CACHE_SIZE];
+
+static void *ffiSymbol(AstTree *library_tree, AstTree *name_tree) {
+  const AstTreeRawValue *library = library_tree->metadata;
+  const AstTreeRawValue *name = name_tree->metadata;
+  if (!ffiIsLiteral(library_tree) || !ffiIsLiteral(name_tree)) {
+    return ffiSymbolLookup(library, name);
+  }
+
+  FfiCacheEntry *entry =
+      &FFI_CACHE[((uintptr_t)name->data ^ (uintptr_t)library->data) %
+                 FFI_CACHE_SIZE];
+  if (entry->library != library->data || entry->name != name->data) {
+    *entry = (FfiCacheEntry){
+        .library = library->data,
+        .name = name->data,
+        .symbol = ffiSymbolLookup(library, name),
+    };
+  }
+  return entry->symbol;
+}
+
+// the address of what the pointer points to as a native pointer
+static void *ffiPointer(AstTree *tree) {
+  AstTreeVariable *variable = tree->metadata;
+  AstTree *value = variable->value;
+  if (value == NULL) {
+    printLog("Pointer to a variable without value");
+    UNREACHABLE;
+  }
+  switch (value->token) {
+  case AST_TREE_TOKEN_VALUE_INT:
+  case AST_TREE_TOKEN_VALUE_BOOL:
+    return value->metadata;
+  case AST_TREE_TOKEN_RAW_VALUE:
+    runnerRawUnshare(value->metadata);
+    return ((AstTreeRawValue *)value->metadata)->data;
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+    return ((AstTreeRawValue *)value->metadata)->data;
+  default:
+    printLog("Can't pass a pointer to %s",
+             AST_TREE_TOKEN_STRINGS[value->token]);
+    UNREACHABLE;
+  }
+}
+
+static AstTreeInt ffiInt(AstTree *type, u64 value) {
+  if (typeIsEqual(type, &AST_TREE_I8_TYPE)) {
+    return (i8)value;
+  } else if (typeIsEqual(type, &AST_TREE_U8_TYPE)) {
+    return (u8)value;
+  } else if (typeIsEqual(type, &AST_TREE_I16_TYPE)) {
+    return (i16)value;
+  } else if (typeIsEqual(type, &AST_TREE_U16_TYPE)) {
+    return (u16)value;
+  } else if (typeIsEqual(type, &AST_TREE_I32_TYPE)) {
+    return (i32)value;
+  } else if (typeIsEqual(type, &AST_TREE_U32_TYPE)) {
+    return (u32)value;
+  } else {
+    return value;
+  }
+}
+
+static bool ffiIsString(AstTree *type) {
+  return type->token == AST_TREE_TOKEN_TYPE_ARRAY &&
+         typeIsEqual(((AstTreeBracket *)type->metadata)->operand,
+                     &AST_TREE_U8_TYPE);
+}
+
+// a u8 array passed as a NUL terminated copy of its bytes
+typedef struct FfiString {
+  AstTree *argument;
+  char *copy;
+} FfiString;
+
+// writes back what the native function changed in the copies of slices and
+// frees them, arrays are values and literals are never written
+static void ffiStringsRelease(FfiString *strings, size_t strings_size) {
+  for (size_t i = 0; i < strings_size; ++i) {
+    AstTree *argument = strings[i].argument;
+    AstTreeRawValue *raw = argument->metadata;
+    if (argument->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED &&
+        !ffiIsLiteral(argument) &&
+        memcmp(raw->data, strings[i].copy, raw->size) != 0) {
+      runnerCheckWritable(raw);
+      memcpy(raw->data, strings[i].copy, raw->size);
+    }
+    free(strings[i].copy);
+  }
+}
+
+// what the native function left in the buffer of stdio goes out before the
+// next output of the program
+static void ffiReturned(FfiString *strings, size_t strings_size) {
+  fflush(stdout);
+  ffiStringsRelease(strings, strings_size);
+}
+
+AstTree *ffiCall(AstTree **arguments, size_t arguments_size) {
+#if defined(__x86_64__) || defined(__aarch64__)
+  void *function = ffiSymbol(arguments[0], arguments[1]);
+  AstTree *returnType = arguments[2];
+
+  u64 ints[FFI_INT_ARGUMENTS] = {0};
+  size_t ints_size = 0;
+  FfiString strings[FFI_INT_ARGUMENTS];
+  size_t strings_size = 0;
+  f64 floats[FFI_FLOAT_ARGUMENTS] = {0};
+  size_t floats_size = 0;
+
+  for (size_t i = 3; i < arguments_size; ++i) {
+    AstTree *argument = arguments[i];
+    if (argument->token == AST_TREE_TOKEN_VALUE_FLOAT) {
+      if (floats_size == FFI_FLOAT_ARGUMENTS) {
+        printLog("Too many float arguments");
+        UNREACHABLE;
+      }
+      const AstTreeFloat value = *(AstTreeFloat *)argument->metadata;
+      if (typeIsEqual(argument->type, &AST_TREE_F64_TYPE)) {
+        floats[floats_size++] = value;
+      } else if (typeIsEqual(argument->type, &AST_TREE_F32_TYPE)) {
+        // the callee reads the low half of the register
+        const f32 f = value;
+        u64 bits = 0;
+        memcpy(&bits, &f, sizeof(f));
+        memcpy(&floats[floats_size++], &bits, sizeof(bits));
+      } else {
+        printLog("Only f32 and f64 can be passed");
+        UNREACHABLE;
+      }
+      continue;
+    }
+
+    if (ints_size == FFI_INT_ARGUMENTS) {
+      printLog("Too many int arguments");
+      UNREACHABLE;
+    }
+    switch (argument->token) {
+    case AST_TREE_TOKEN_VALUE_INT:
+      ints[ints_size++] = *(AstTreeInt *)argument->metadata;
+      break;
+    case AST_TREE_TOKEN_VALUE_BOOL:
+      ints[ints_size++] = *(AstTreeBool *)argument->metadata;
+      break;
+    case AST_TREE_TOKEN_VALUE_NULL:
+      ints[ints_size++] = 0;
+      break;
+    case AST_TREE_TOKEN_RAW_VALUE:
+    case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+      if (ffiIsString(argument->type)) {
+        FfiString *string = &strings[strings_size++];
+        string->argument = argument;
+        string->copy = ffiString(argument->metadata);
+        ints[ints_size++] = (u64)(uintptr_t)string->copy;
+        break;
+      }
+      // other arrays, slices and structs are passed as pointers to their bytes
+      ints[ints_size++] =
+          (u64)(uintptr_t)((AstTreeRawValue *)argument->metadata)->data;
+      break;
+    case AST_TREE_TOKEN_VARIABLE:
+      ints[ints_size++] = (u64)(uintptr_t)ffiPointer(argument);
+      break;
+    default:
+      printLog("Can't pass %s to a native function",
+               AST_TREE_TOKEN_STRINGS[argument->token]);
+      UNREACHABLE;
+    }
+  }
+
+  // native code writes to stdout itself, what the program wrote comes first
+  outputFlush();
+
+#define FFI_ARGUMENTS                                                          \
+  ints[0], ints[1], ints[2], ints[3], ints[4], ints[5], floats[0], floats[1],  \
+      floats[2], floats[3], floats[4], floats[5], floats[6], floats[7]
+
+  if (typeIsEqual(returnType, &AST_TREE_F64_TYPE)) {
+    AstTreeFloat *value = a404m_slab_malloc(sizeof(*value));
+    *value = ((FfiF64Function)function)(FFI_ARGUMENTS);
+    ffiReturned(strings, strings_size);
+    return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, value,
+                      copyAstTree(returnType), NULL, NULL);
+  } else if (typeIsEqual(returnType, &AST_TREE_F32_TYPE)) {
+    AstTreeFloat *value = a404m_slab_malloc(sizeof(*value));
+    *value = ((FfiF32Function)function)(FFI_ARGUMENTS);
+    ffiReturned(strings, strings_size);
+    return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, value,
+                      copyAstTree(returnType), NULL, NULL);
+  }
+
+  const u64 ret = ((FfiIntFunction)function)(FFI_ARGUMENTS);
+#undef FFI_ARGUMENTS
+  ffiReturned(strings, strings_size);
+  if (typeIsEqual(returnType, &AST_TREE_VOID_TYPE)) {
+    return &AST_TREE_VOID_VALUE;
+  } else if (typeIsEqual(returnType, &AST_TREE_BOOL_TYPE)) {
+    AstTreeBool *value = a404m_slab_malloc(sizeof(*value));
+    *value = (u8)ret != 0;
+    return newAstTree(AST_TREE_TOKEN_VALUE_BOOL, value,
+                      copyAstTree(returnType), NULL, NULL);
+  } else if (isIntType(returnType)) {
+    AstTreeInt *value = a404m_slab_malloc(sizeof(*value));
+    *value = ffiInt(returnType, ret);
+    return newAstTree(AST_TREE_TOKEN_VALUE_INT, value, copyAstTree(returnType),
+                      NULL, NULL);
+  }
+  printLog("Native functions can only return void, bool, int, f32 and f64");
+  UNREACHABLE;
+#else
+  (void)arguments;
+  (void)arguments_size;
+  printLog("@ffi is not supported on this target");
+  UNREACHABLE;
+#endif
+}
+
+void ffiDestroy() {
+  for (size_t i = 0; i < FFI_SYMBOLS.size; ++i) {
+    FfiSymbol symbol = FFI_SYMBOLS.data[i];
+    dlclose(symbol.handle);
+    free(symbol.library);
+    free(symbol.name);
+  }
+  free(FFI_SYMBOLS.data);
+  FFI_SYMBOLS.data = NULL;
+  FFI_SYMBOLS.size = 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "compiler/ast-tree.h"
+
+// runs @ffi(library, name, returnType, ...) with its evaluated arguments
+// u8 arrays are passed as NUL terminated copies, what the native function
+// writes to the copy of a slice is written back to the slice, a pointer to an
+// array passes its own bytes without a NUL
+// symbols are looked up once per call site when the names are literals
+AstTree *ffiCall(AstTree **arguments, size_t arguments_size);
+
+// closes the libraries that calls opened
+void ffiDestroy();
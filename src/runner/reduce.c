@@ -0,0 +1,296 @@
+#include "reduce.h"
+
+#include "utils/log.h"
+#include "utils/memory.h"
+#include <string.h>
+
+// the kernels are written with the vector extension of gcc and clang, on
+// x86-64 they are built for both sse2 which every x86-64 has and avx2 which
+// is picked if cpuid reports it
+#if defined(__GNUC__)
+#define REDUCE_VECTOR
+#if defined(__x86_64__)
+#define REDUCE_X86
+#endif
+#endif
+
+#define REDUCE_TARGET_AVX2 __attribute__((target("avx2")))
+#define REDUCE_TARGET_DEFAULT
+
+// kernels over vectors of the given bits, two accumulators hide the latency
+// of the adds, the lanes and the tail are reduced at the end, sums of ints are
+// done in the unsigned type so they wrap around without overflow and scalar
+// products go through unsigned int since narrow types are promoted to int
+#define REDUCE_VECTOR_KERNELS(bits, target, ctype, utype, mtype, suffix)       \
+  typedef ctype Reduce##bits##suffix __attribute__((vector_size(bits / 8)));   \
+  typedef utype Reduce##bits##suffix##Sum                                      \
+      __attribute__((vector_size(bits / 8)));                                  \
+  typedef mtype Reduce##bits##suffix##Mask                                     \
+      __attribute__((vector_size(bits / 8)));                                  \
+                                                                               \
+  target static ctype reduce##bits##Sum##suffix(const ctype *data,             \
+                                                size_t size) {                 \
+    const utype *values = (const utype *)data;                                 \
+    const size_t lanes = bits / 8 / sizeof(ctype);                             \
+    Reduce##bits##suffix##Sum acc0 = {0};                                      \
+    Reduce##bits##suffix##Sum acc1 = {0};                                      \
+    size_t i = 0;                                                              \
+    for (; i + 2 * lanes <= size; i += 2 * lanes) {                            \
+      Reduce##bits##suffix##Sum a, b;                                          \
+      memcpy(&a, values + i, sizeof(a));                                       \
+      memcpy(&b, values + i + lanes, sizeof(b));                               \
+      acc0 += a;                                                               \
+      acc1 += b;                                                               \
+    }                                                                          \
+    acc0 += acc1;                                                              \
+    utype res = 0;                                                             \
+    for (size_t j = 0; j < lanes; ++j) {                                       \
+      res += acc0[j];                                                          \
+    }                                                                          \
+    for (; i < size; ++i) {                                                    \
+      res += values[i];                                                        \
+    }                                                                          \
+    return res;                                                                \
+  }                                                                            \
+                                                                               \
+  target static ctype reduce##bits##Dot##suffix(                               \
+      const ctype *left, const ctype *right, size_t size) {                    \
+    const utype *lefts = (const utype *)left;                                  \
+    const utype *rights = (const utype *)right;                                \
+    const size_t lanes = bits / 8 / sizeof(ctype);                             \
+    Reduce##bits##suffix##Sum acc0 = {0};                                      \
+    Reduce##bits##suffix##Sum acc1 = {0};                                      \
+    size_t i = 0;                                                              \
+    for (; i + 2 * lanes <= size; i += 2 * lanes) {                            \
+      Reduce##bits##suffix##Sum a, b, c, d;                                    \
+      memcpy(&a, lefts + i, sizeof(a));                                        \
+      memcpy(&b, lefts + i + lanes, sizeof(b));                                \
+      memcpy(&c, rights + i, sizeof(c));                                       \
+      memcpy(&d, rights + i + lanes, sizeof(d));                               \
+      acc0 += a * c;                                                           \
+      acc1 += b * d;                                                           \
+    }                                                                          \
+    acc0 += acc1;                                                              \
+    utype res = 0;                                                             \
+    for (size_t j = 0; j < lanes; ++j) {                                       \
+      res += acc0[j];                                                          \
+    }                                                                          \
+    for (; i < size; ++i) {                                                    \
+      res += lefts[i] * 1u * rights[i];                                        \
+    }                                                                          \
+    return res;                                                                \
+  }                                                                            \
+                                                                               \
+  REDUCE_VECTOR_EXTREME(bits, target, ctype, suffix, Min, <)                   \
+  REDUCE_VECTOR_EXTREME(bits, target, ctype, suffix, Max, >)
+
+// there is no ternary for vectors so the lanes are picked by the mask of the
+// comparison, size must not be zero
+#define REDUCE_VECTOR_EXTREME(bits, target, ctype, suffix, name, op)           \
+  target static ctype reduce##bits##name##suffix(const ctype *data,            \
+                                                 size_t size) {                \
+    const size_t lanes = bits / 8 / sizeof(ctype);                             \
+    ctype res = data[0];                                                       \
+    size_t i = 0;                                                              \
+    if (size >= lanes) {                                                       \
+      Reduce##bits##suffix acc;                                                \
+      memcpy(&acc, data, sizeof(acc));                                         \
+      for (i = lanes; i + lanes <= size; i += lanes) {                         \
+        Reduce##bits##suffix a;                                                \
+        memcpy(&a, data + i, sizeof(a));                                       \
+        const Reduce##bits##suffix##Mask mask = a op acc;                      \
+        acc = (Reduce##bits##suffix)(((Reduce##bits##suffix##Mask)a & mask) |  \
+                                     ((Reduce##bits##suffix##Mask)acc &        \
+                                      ~mask));                                 \
+      }                                                                        \
+      res = acc[0];                                                            \
+      for (size_t j = 1; j < lanes; ++j) {                                     \
+        if (acc[j] op res) {                                                   \
+          res = acc[j];                                                        \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    for (; i < size; ++i) {                                                    \
+      if (data[i] op res) {                                                    \
+        res = data[i];                                                         \
+      }                                                                        \
+    }                                                                          \
+    return res;                                                                \
+  }
+
+// for the types that have no vectors and targets without the extension
+#define REDUCE_SCALAR_KERNELS(ctype, utype, suffix)                            \
+  static ctype reduceScalarSum##suffix(const ctype *data, size_t size) {       \
+    const utype *values = (const utype *)data;                                 \
+    utype res = 0;                                                             \
+    for (size_t i = 0; i < size; ++i) {                                        \
+      res += values[i];                                                        \
+    }                                                                          \
+    return res;                                                                \
+  }                                                                            \
+                                                                               \
+  static ctype reduceScalarDot##suffix(const ctype *left, const ctype *right,  \
+                                       size_t size) {                          \
+    const utype *lefts = (const utype *)left;                                  \
+    const utype *rights = (const utype *)right;                                \
+    utype res = 0;                                                             \
+    for (size_t i = 0; i < size; ++i) {                                        \
+      res += lefts[i] * 1u * rights[i];                                        \
+    }                                                                          \
+    return res;                                                                \
+  }                                                                            \
+                                                                               \
+  static ctype reduceScalarMin##suffix(const ctype *data, size_t size) {       \
+    ctype res = data[0];                                                       \
+    for (size_t i = 1; i < size; ++i) {                                        \
+      if (data[i] < res) {                                                     \
+        res = data[i];                                                         \
+      }                                                                        \
+    }                                                                          \
+    return res;                                                                \
+  }                                                                            \
+                                                                               \
+  static ctype reduceScalarMax##suffix(const ctype *data, size_t size) {       \
+    ctype res = data[0];                                                       \
+    for (size_t i = 1; i < size; ++i) {                                        \
+      if (data[i] > res) {                                                     \
+        res = data[i];                                                         \
+      }                                                                        \
+    }                                                                          \
+    return res;                                                                \
+  }
+
+// the type, the one its sums wrap around in and the one of its comparisons,
+// i8 is char whose sign depends on the target
+#define REDUCE_TYPES(KERNELS)                                                  \
+  KERNELS(signed char, u8, signed char, I8)                                    \
+  KERNELS(u8, u8, signed char, U8)                                             \
+  KERNELS(i16, u16, i16, I16)                                                  \
+  KERNELS(u16, u16, i16, U16)                                                  \
+  KERNELS(i32, u32, i32, I32)                                                  \
+  KERNELS(u32, u32, i32, U32)                                                  \
+  KERNELS(i64, u64, i64, I64)                                                  \
+  KERNELS(u64, u64, i64, U64)                                                  \
+  KERNELS(f32, f32, i32, F32)                                                  \
+  KERNELS(f64, f64, i64, F64)
+
+#define REDUCE_SCALAR_TYPE(ctype, utype, mtype, suffix)                        \
+  REDUCE_SCALAR_KERNELS(ctype, utype, suffix)
+#define REDUCE_128_TYPE(ctype, utype, mtype, suffix)                           \
+  REDUCE_VECTOR_KERNELS(128, REDUCE_TARGET_DEFAULT, ctype, utype, mtype,       \
+                        suffix)
+#define REDUCE_256_TYPE(ctype, utype, mtype, suffix)                           \
+  REDUCE_VECTOR_KERNELS(256, REDUCE_TARGET_AVX2, ctype, utype, mtype, suffix)
+
+#ifdef REDUCE_VECTOR
+REDUCE_TYPES(REDUCE_128_TYPE)
+#else
+REDUCE_TYPES(REDUCE_SCALAR_TYPE)
+#endif
+#ifdef REDUCE_X86
+REDUCE_TYPES(REDUCE_256_TYPE)
+#endif
+#ifdef FLOAT_16_SUPPORT
+REDUCE_SCALAR_KERNELS(f16, f16, F16)
+#endif
+REDUCE_SCALAR_KERNELS(f128, f128, F128)
+
+#if defined(REDUCE_X86)
+// cpuid is read once at startup so this is only a load
+#define REDUCE_KERNEL(name, suffix)                                            \
+  (__builtin_cpu_supports("avx2") ? reduce256##name##suffix                    \
+                                  : reduce128##name##suffix)
+#elif defined(REDUCE_VECTOR)
+#define REDUCE_KERNEL(name, suffix) reduce128##name##suffix
+#else
+#define REDUCE_KERNEL(name, suffix) reduceScalar##name##suffix
+#endif
+#define REDUCE_SCALAR_KERNEL(name, suffix) reduceScalar##name##suffix
+
+static AstTree *reduceInt(AstTree *type, AstTreeInt res) {
+  AstTreeInt *value = a404m_slab_malloc(sizeof(*value));
+  *value = res;
+  return newAstTree(AST_TREE_TOKEN_VALUE_INT, value, copyAstTree(type), NULL,
+                    NULL);
+}
+
+static AstTree *reduceFloat(AstTree *type, AstTreeFloat res) {
+  AstTreeFloat *value = a404m_slab_malloc(sizeof(*value));
+  *value = res;
+  return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, value, copyAstTree(type),
+                    NULL, NULL);
+}
+
+#define REDUCE_CASE(type_token, ctype, suffix, KERNEL, result)                 \
+  case type_token: {                                                           \
+    const ctype *data = (const ctype *)left->data;                             \
+    const size_t size = left->size / sizeof(ctype);                            \
+    ctype res;                                                                 \
+    switch (token) {                                                           \
+    case AST_TREE_TOKEN_BUILTIN_SUM:                                           \
+      res = KERNEL(Sum, suffix)(data, size);                                   \
+      break;                                                                   \
+    case AST_TREE_TOKEN_BUILTIN_MIN:                                           \
+      res = KERNEL(Min, suffix)(data, size);                                   \
+      break;                                                                   \
+    case AST_TREE_TOKEN_BUILTIN_MAX:                                           \
+      res = KERNEL(Max, suffix)(data, size);                                   \
+      break;                                                                   \
+    case AST_TREE_TOKEN_BUILTIN_DOT:                                           \
+      res = KERNEL(Dot, suffix)(data, (const ctype *)right->data, size);       \
+      break;                                                                   \
+    default:                                                                   \
+      UNREACHABLE;                                                             \
+    }                                                                          \
+    return result(element, res);                                               \
+  }
+
+static AstTreeRawValue *reduceRaw(AstTree *tree) {
+  if (tree->token != AST_TREE_TOKEN_RAW_VALUE &&
+      tree->token != AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
+    printLog("Can't read from %s", AST_TREE_TOKEN_STRINGS[tree->token]);
+    UNREACHABLE;
+  }
+  return tree->metadata;
+}
+
+AstTree *reduceRun(AstTreeToken token, AstTree **arguments) {
+  AstTreeRawValue *left = reduceRaw(arguments[0]);
+  AstTreeRawValue *right = NULL;
+  AstTree *element = ((AstTreeBracket *)arguments[0]->type->metadata)->operand;
+
+  if (token == AST_TREE_TOKEN_BUILTIN_DOT) {
+    right = reduceRaw(arguments[1]);
+    if (left->size != right->size) {
+      printLog("Arrays of @dot must have the same length");
+      UNREACHABLE;
+    }
+  } else if (token != AST_TREE_TOKEN_BUILTIN_SUM && left->size == 0) {
+    printLog("Empty array has no %s",
+             token == AST_TREE_TOKEN_BUILTIN_MIN ? "@min" : "@max");
+    UNREACHABLE;
+  }
+
+  switch (element->token) {
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_I8, signed char, I8, REDUCE_KERNEL,
+                reduceInt)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_U8, u8, U8, REDUCE_KERNEL, reduceInt)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_I16, i16, I16, REDUCE_KERNEL, reduceInt)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_U16, u16, U16, REDUCE_KERNEL, reduceInt)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_I32, i32, I32, REDUCE_KERNEL, reduceInt)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_U32, u32, U32, REDUCE_KERNEL, reduceInt)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_I64, i64, I64, REDUCE_KERNEL, reduceInt)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_U64, u64, U64, REDUCE_KERNEL, reduceInt)
+#ifdef FLOAT_16_SUPPORT
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_F16, f16, F16, REDUCE_SCALAR_KERNEL,
+                reduceFloat)
+#endif
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_F32, f32, F32, REDUCE_KERNEL, reduceFloat)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_F64, f64, F64, REDUCE_KERNEL, reduceFloat)
+    REDUCE_CASE(AST_TREE_TOKEN_TYPE_F128, f128, F128, REDUCE_SCALAR_KERNEL,
+                reduceFloat)
+  default:
+  }
+  printLog("Can't reduce array of %s", AST_TREE_TOKEN_STRINGS[element->token]);
+  UNREACHABLE;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "compiler/ast-tree.h"
+
+// runs @sum, @min, @max and @dot with their evaluated arguments
+AstTree *reduceRun(AstTreeToken token, AstTree **arguments);
@@ -1,31 +1,20 @@
 #include "runner.h"
 #include "compiler/ast-tree.h"
+#include "runner/ffi.h"
+#include "runner/reduce.h"
+#include "runner/thread.h"
+#include "runner/vm.h"
+#include "utils/file.h"
+#include "utils/input.h"
 #include "utils/log.h"
 #include "utils/memory.h"
+#include "utils/output.h"
 #include "utils/string.h"
 #include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-
-#define doOperation(op0, op1, operator, originalType, type)                    \
-  *((originalType *)(op0)->metadata) =                                         \
-      (originalType)(((type) * (originalType *)(op0)->metadata) operator(      \
-          (type) * (originalType *)(op1)->metadata))
-
-#define doLogicalOperation(op0, op1, operator, originalType, _type)            \
-  {                                                                            \
-    bool *res = a404m_malloc(sizeof(*res));                                    \
-    *res = ((_type) * ((originalType *)(op0)->metadata)) operator(             \
-        (_type) * ((originalType *)(op1)->metadata));                          \
-    astTreeDestroy(*(op0));                                                    \
-    (op0)->metadata = res;                                                     \
-    (op0)->type = &AST_TREE_BOOL_TYPE;                                         \
-    (op0)->token = AST_TREE_TOKEN_VALUE_BOOL;                                  \
-  }
-
-#define doLeftOperation(op0, operator, originalType, type)                     \
-  *((originalType *)(op0)->metadata) = operator(                               \
-      (type) * (originalType *)(op0)->metadata)
+#include <string.h>
 
 void runnerVariableSetValue(AstTreeVariable *variable, AstTree *value) {
   if (variable->isConst) {
@@ -35,14 +24,443 @@ void runnerVariableSetValue(AstTreeVariable *variable, AstTree *value) {
   runnerVariableSetValueWihtoutConstCheck(variable, value);
 }
 
+// values stored in variables outlive the arena of the leaf call that makes
+// them, only temporaries stay in it
+AstTree *runnerArenaEscape(AstTree *value) {
+  if (!a404m_arena_owns(value)) {
+    return value;
+  }
+  const bool wasOpen = a404m_arena_pause();
+  AstTree *result = copyAstTree(value);
+  a404m_arena_resume(wasOpen);
+  astTreeDelete(value);
+  return result;
+}
+
 void runnerVariableSetValueWihtoutConstCheck(AstTreeVariable *variable,
                                              AstTree *value) {
+  value = runnerArenaEscape(value);
+  if (variable->isGlobal && threadGlobalsShared()) {
+    threadGlobalSet(variable, value);
+    return;
+  }
   if (variable->value != NULL) {
     astTreeDelete(variable->value);
   }
   variable->value = value;
 }
 
+// globals are read, made and given their own bytes under the lock of them
+// while other threads share them
+static bool runnerGlobalLock(AstTreeVariable *variable) {
+  if (variable->isGlobal && threadGlobalsShared()) {
+    threadGlobalsLock();
+    return true;
+  }
+  return false;
+}
+
+static void runnerGlobalUnlock(bool locked) {
+  if (locked) {
+    threadGlobalsUnlock();
+  }
+}
+
+AstTree *runnerVariableGetValue(AstTreeVariable *variable) {
+  const bool locked = runnerGlobalLock(variable);
+  if (variable->value == NULL) {
+    UNREACHABLE;
+  }
+  AstTree *value = copyAstTree(variable->value);
+  runnerGlobalUnlock(locked);
+  return value;
+}
+
+static AstTree *runnerArraySize(AstTreeBracket *array_metadata) {
+  if (array_metadata->parameters.size != 1) {
+    UNREACHABLE;
+  }
+  bool shouldRet = false;
+  u32 breakCount = 0;
+  bool shouldContinue = false;
+  AstTree *sizeTree =
+      runExpression(array_metadata->parameters.data[0], NULL, &shouldRet,
+                    false, false, &breakCount, &shouldContinue);
+  if (sizeTree->token != AST_TREE_TOKEN_VALUE_INT) {
+    UNREACHABLE;
+  }
+  return sizeTree;
+}
+
+// gives the value its own bytes before a write if its copies share them
+void runnerRawUnshare(AstTreeRawValue *raw) {
+  if (rawDataIsShared(raw->data)) {
+    u8 *data = newRawData(raw->size);
+    memcpy(data, raw->data, raw->size);
+    rawDataDelete(raw->data);
+    raw->data = data;
+  }
+}
+
+// structs of int, float and bool members are kept flat and the others as
+// objects of variables
+static void runnerStructMake(AstTreeVariable *variable) {
+  if (variable->value->token != AST_TREE_TOKEN_VALUE_UNDEFINED) {
+    return;
+  }
+  AstTreeStruct *struc = variable->type->metadata;
+
+  if (struc->offsets != NULL && struc->size != 0) {
+    AstTreeRawValue *newMetadata = a404m_malloc(sizeof(*newMetadata));
+    newMetadata->size = struc->size;
+    newMetadata->data = newRawData(newMetadata->size);
+    memset(newMetadata->data, 0, newMetadata->size);
+
+    runnerVariableSetValue(variable, newAstTree(AST_TREE_TOKEN_RAW_VALUE,
+                                                newMetadata,
+                                                copyAstTree(variable->type),
+                                                variable->value->str_begin,
+                                                variable->value->str_end));
+    return;
+  }
+
+  AstTreeObject *newMetadata = a404m_malloc(sizeof(*newMetadata));
+
+  newMetadata->variables =
+      copyAstTreeVariables(struc->variables, NULL, NULL, 0, false);
+
+  for (size_t i = 0; i < newMetadata->variables.size; ++i) {
+    AstTreeVariable *member = newMetadata->variables.data[i];
+    if (!member->isConst) {
+      runnerVariableSetValue(member,
+                             newAstTree(AST_TREE_TOKEN_VALUE_UNDEFINED, NULL,
+                                        copyAstTree(member->type),
+                                        variable->value->str_begin,
+                                        variable->value->str_end));
+    }
+  }
+
+  runnerVariableSetValue(variable, newAstTree(AST_TREE_TOKEN_VALUE_OBJECT,
+                                              newMetadata,
+                                              copyAstTree(variable->type),
+                                              variable->value->str_begin,
+                                              variable->value->str_end));
+}
+
+static void runnerStructMaterialize(AstTreeVariable *variable) {
+  const bool locked = runnerGlobalLock(variable);
+  runnerStructMake(variable);
+  runnerGlobalUnlock(locked);
+}
+
+u8 *runnerStructRawMember(AstTreeVariable *variable, size_t index,
+                          AstTree **type, bool isLeft) {
+  const bool locked = runnerGlobalLock(variable);
+  runnerStructMake(variable);
+  AstTree *value = variable->value;
+  u8 *result = NULL;
+  if (value->token == AST_TREE_TOKEN_RAW_VALUE) {
+    AstTreeStruct *struc = value->type->metadata;
+    AstTreeVariable *member = struc->variables.data[index];
+    if (!member->isConst) {
+      AstTreeRawValue *raw = value->metadata;
+      if (isLeft) {
+        runnerRawUnshare(raw);
+      }
+      *type = member->type;
+      result = raw->data + struc->offsets[index];
+    }
+  }
+  runnerGlobalUnlock(locked);
+  return result;
+}
+
+AstTreeVariable *runnerStructMember(AstTreeVariable *variable, size_t index) {
+  runnerStructMaterialize(variable);
+  if (variable->value->token == AST_TREE_TOKEN_RAW_VALUE) {
+    // flat structs only store the others, const members live in the type
+    AstTreeStruct *struc = variable->value->type->metadata;
+    AstTreeVariable *member = struc->variables.data[index];
+    if (!member->isConst) {
+      UNREACHABLE;
+    }
+    return member;
+  }
+  AstTreeObject *object = variable->value->metadata;
+  return object->variables.data[index];
+}
+
+// an undefined array that is given to a slice keeps the type of the array
+static AstTree *runnerUndefinedArrayType(AstTreeVariable *variable) {
+  AstTree *type = variable->value->type;
+  if (type != NULL && type->token == AST_TREE_TOKEN_TYPE_ARRAY &&
+      ((AstTreeBracket *)type->metadata)->parameters.size != 0) {
+    return type;
+  }
+  return variable->type;
+}
+
+AstTree *runnerAccessMember(AstTreeVariable *variable, size_t index,
+                            bool isLeft) {
+  if (variable->type->token == AST_TREE_TOKEN_TYPE_ARRAY) {
+    if (index != 0) {
+      UNREACHABLE;
+    } else if (variable->value->token == AST_TREE_TOKEN_VALUE_UNDEFINED) {
+      return runnerArraySize(runnerUndefinedArrayType(variable)->metadata);
+    } else if (variable->value->token == AST_TREE_TOKEN_VALUE_OBJECT) {
+      AstTreeObject *object = variable->value->metadata;
+      AstTreeInt *res_metadata = a404m_slab_malloc(sizeof(*res_metadata));
+      *res_metadata = object->variables.size;
+      return newAstTree(AST_TREE_TOKEN_VALUE_INT, res_metadata,
+                        &AST_TREE_U64_TYPE, NULL, NULL);
+    } else if (variable->value->token == AST_TREE_TOKEN_RAW_VALUE ||
+               variable->value->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
+      AstTreeBracket *array_type_metadata = variable->value->type->metadata;
+      AstTreeRawValue *raw = variable->value->metadata;
+      AstTreeInt *res_metadata = a404m_slab_malloc(sizeof(*res_metadata));
+      *res_metadata = raw->size / getSizeOfType(array_type_metadata->operand);
+      return newAstTree(AST_TREE_TOKEN_VALUE_INT, res_metadata,
+                        &AST_TREE_U64_TYPE, NULL, NULL);
+    }
+  } else if (variable->type->token == AST_TREE_TOKEN_KEYWORD_STRUCT) {
+    AstTree *type;
+    u8 *raw = runnerStructRawMember(variable, index, &type, isLeft);
+    if (raw != NULL) {
+      if (isLeft) {
+        return valueToTree((Value){
+            .tag = VALUE_TAG_RAW_REF,
+            .type = type,
+            .raw = raw,
+        });
+      } else {
+        return valueToTree(valueLoadRaw(type, raw));
+      }
+    }
+
+    AstTreeVariable *var = runnerStructMember(variable, index);
+    if (isLeft) {
+      return newAstTree(AST_TREE_TOKEN_VARIABLE, var, copyAstTree(var->type),
+                        var->name_begin, var->name_end);
+    } else {
+      return copyAstTree(var->value);
+    }
+  }
+  UNREACHABLE;
+}
+
+// arrays of int, float and bool elements are kept flat and the others as
+// objects of variables
+static void runnerArrayMake(AstTreeVariable *variable) {
+  if (variable->value->token != AST_TREE_TOKEN_VALUE_UNDEFINED) {
+    return;
+  }
+  AstTree *array_type = runnerUndefinedArrayType(variable);
+  AstTreeBracket *array_type_metadata = array_type->metadata;
+  AstTree *arraySize_tree = runnerArraySize(array_type_metadata);
+  AstTreeInt array_size = *(AstTreeInt *)arraySize_tree->metadata;
+  astTreeDelete(arraySize_tree);
+
+  if (isRawType(array_type_metadata->operand)) {
+    AstTreeRawValue *newMetadata = a404m_malloc(sizeof(*newMetadata));
+    newMetadata->size =
+        array_size * getSizeOfType(array_type_metadata->operand);
+    newMetadata->data = newRawData(newMetadata->size);
+    memset(newMetadata->data, 0, newMetadata->size);
+
+    runnerVariableSetValue(variable, newAstTree(AST_TREE_TOKEN_RAW_VALUE,
+                                                newMetadata,
+                                                copyAstTree(variable->type),
+                                                variable->value->str_begin,
+                                                variable->value->str_end));
+    return;
+  }
+
+  AstTreeObject *newMetadata = a404m_malloc(sizeof(*newMetadata));
+
+  newMetadata->variables = (AstTreeVariables){
+      .data = a404m_malloc(array_size * sizeof(*newMetadata->variables.data)),
+      .size = array_size,
+  };
+
+  for (size_t i = 0; i < array_size; ++i) {
+    AstTreeVariable *member = a404m_slab_malloc(sizeof(*member));
+    member->name_begin = member->name_end = NULL;
+    member->isConst = false;
+    member->isLazy = false;
+    member->isByName = false;
+    member->isGlobal = false;
+    member->slot = 0;
+    member->type = copyAstTree(array_type_metadata->operand);
+    member->value = newAstTree(
+        AST_TREE_TOKEN_VALUE_UNDEFINED, NULL, copyAstTree(member->type),
+        variable->value->str_begin, variable->value->str_end);
+    member->initValue = NULL;
+    newMetadata->variables.data[i] = member;
+  }
+
+  runnerVariableSetValue(variable, newAstTree(AST_TREE_TOKEN_VALUE_OBJECT,
+                                              newMetadata,
+                                              copyAstTree(variable->type),
+                                              variable->value->str_begin,
+                                              variable->value->str_end));
+}
+
+static void runnerArrayMaterialize(AstTreeVariable *variable) {
+  const bool locked = runnerGlobalLock(variable);
+  runnerArrayMake(variable);
+  runnerGlobalUnlock(locked);
+}
+
+// views of sized arrays are string literals, their bytes are immutable so
+// they are copied before the first write, views of slices are memory of
+// @stackAlloc or @heapAlloc that is written in place or of @mapFile that can't
+// be written
+static bool runnerIsSizedArray(AstTree *type) {
+  AstTreeBracket *metadata = type->metadata;
+  return metadata->parameters.size != 0;
+}
+
+// bytes of a flat array variable, they are its own if they are written
+static AstTreeRawValue *runnerArrayBytes(AstTreeVariable *variable,
+                                         bool isLeft) {
+  runnerArrayMake(variable);
+  AstTree *value = variable->value;
+  if (isLeft && value->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED &&
+      runnerIsSizedArray(value->type)) {
+    AstTreeRawValue *raw = value->metadata;
+    AstTreeRawValue *newMetadata = a404m_malloc(sizeof(*newMetadata));
+    newMetadata->size = raw->size;
+    newMetadata->data = newRawData(newMetadata->size);
+    memcpy(newMetadata->data, raw->data, newMetadata->size);
+
+    runnerVariableSetValueWihtoutConstCheck(
+        variable,
+        newAstTree(AST_TREE_TOKEN_RAW_VALUE, newMetadata,
+                   copyAstTree(value->type), value->str_begin, value->str_end));
+    value = variable->value;
+  } else if (isLeft && value->token == AST_TREE_TOKEN_RAW_VALUE) {
+    runnerRawUnshare(value->metadata);
+  } else if (isLeft && value->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
+    runnerCheckWritable(value->metadata);
+  } else if (value->token != AST_TREE_TOKEN_RAW_VALUE &&
+             value->token != AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
+    return NULL;
+  }
+  return value->metadata;
+}
+
+static AstTreeRawValue *runnerArrayRaw(AstTreeVariable *variable,
+                                       bool isLeft) {
+  const bool locked = runnerGlobalLock(variable);
+  AstTreeRawValue *raw = runnerArrayBytes(variable, isLeft);
+  runnerGlobalUnlock(locked);
+  return raw;
+}
+
+bool runnerIsMemoryDestination(AstTreeToken builtin, size_t index,
+                               AstTree *argument) {
+  switch (builtin) {
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+    break;
+  default:
+    return false;
+  }
+  if (index != 0 || argument->token != AST_TREE_TOKEN_VARIABLE ||
+      argument->type->token != AST_TREE_TOKEN_TYPE_ARRAY) {
+    return false;
+  }
+  AstTreeVariable *variable = argument->metadata;
+  return !variable->isConst && !variable->isLazy;
+}
+
+// bytes that @read, @memcpy and @memset write, variables are written like
+// their elements and other values like variables of their own, so literals and
+// shared bytes are copied first and undefined arrays are made
+static AstTreeRawValue *runnerMemoryDestination(AstTree **tree) {
+  AstTreeRawValue *raw;
+  if ((*tree)->token == AST_TREE_TOKEN_VARIABLE) {
+    raw = runnerArrayRaw((*tree)->metadata, true);
+  } else {
+    AstTreeVariable temporary = {
+        .type = (*tree)->type,
+        .value = *tree,
+    };
+    raw = runnerArrayBytes(&temporary, true);
+    *tree = temporary.value;
+  }
+  if (raw == NULL) {
+    printLog("Can't write to %s", AST_TREE_TOKEN_STRINGS[(*tree)->token]);
+    UNREACHABLE;
+  }
+  return raw;
+}
+
+static AstTreeRawValue *runnerMemorySource(AstTree *tree) {
+  if (tree->token != AST_TREE_TOKEN_RAW_VALUE &&
+      tree->token != AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
+    printLog("Can't read from %s", AST_TREE_TOKEN_STRINGS[tree->token]);
+    UNREACHABLE;
+  }
+  return tree->metadata;
+}
+
+u8 *runnerArrayRawElement(AstTreeVariable *variable, AstTreeInt index,
+                          AstTree **type, bool isLeft) {
+  const bool locked = runnerGlobalLock(variable);
+  AstTreeRawValue *raw = runnerArrayBytes(variable, isLeft);
+  if (raw == NULL) {
+    runnerGlobalUnlock(locked);
+    return NULL;
+  }
+  AstTreeBracket *array_type_metadata = variable->value->type->metadata;
+  runnerGlobalUnlock(locked);
+  const size_t size = getSizeOfType(array_type_metadata->operand);
+  if (index >= raw->size / size) {
+    printLog("Index out of range");
+    UNREACHABLE;
+  }
+  *type = array_type_metadata->operand;
+  return raw->data + index * size;
+}
+
+AstTreeVariable *runnerArrayElement(AstTreeVariable *variable,
+                                    AstTreeInt index) {
+  runnerArrayMaterialize(variable);
+  if (variable->value->token != AST_TREE_TOKEN_VALUE_OBJECT) {
+    UNREACHABLE;
+  }
+  AstTreeObject *object = variable->value->metadata;
+  return object->variables.data[index];
+}
+
+AstTree *runnerArrayAccess(AstTreeVariable *variable, AstTreeInt index,
+                           bool isLeft) {
+  AstTree *type;
+  u8 *raw = runnerArrayRawElement(variable, index, &type, isLeft);
+  if (raw != NULL) {
+    if (isLeft) {
+      return valueToTree((Value){
+          .tag = VALUE_TAG_RAW_REF,
+          .type = type,
+          .raw = raw,
+      });
+    } else {
+      return valueToTree(valueLoadRaw(type, raw));
+    }
+  }
+
+  AstTreeVariable *var = runnerArrayElement(variable, index);
+
+  if (isLeft) {
+    return newAstTree(AST_TREE_TOKEN_VARIABLE, var, copyAstTree(var->type),
+                      var->name_begin, var->name_end);
+  } else {
+    return copyAstTree(var->value);
+  }
+}
+
 bool runAstTree(AstTreeRoots roots) {
   static const char MAIN_STR[] = "main";
   static const size_t MAIN_STR_SIZE =
@@ -65,7 +483,9 @@ bool runAstTree(AstTreeRoots roots) {
         mainVariable = variable;
       }
       if (!variable->isConst) {
-        runnerVariableSetValueWihtoutConstCheck(variable, variable->initValue);
+        // the value is written in place, so it can't be the init value
+        runnerVariableSetValueWihtoutConstCheck(
+            variable, copyAstTree(variable->initValue));
       }
     }
   }
@@ -75,24 +495,119 @@ bool runAstTree(AstTreeRoots roots) {
     return false;
   }
 
-  AstTree *main;
-  if (mainVariable->value != NULL) {
-    main = copyAstTree(mainVariable->value);
-  } else {
+  if (mainVariable->value == NULL) {
     printLog("main has no value");
     return false;
   }
 
-  AstTree *res = runAstTreeFunction(main, NULL, 0, false);
+#ifdef RUNNER_TREE_WALKER
+  AstTree *res =
+      runAstTreeFunction(mainVariable->value->metadata, NULL, 0, false);
+  threadDestroy();
   const bool ret = res == &AST_TREE_VOID_VALUE;
   astTreeDelete(res);
-  astTreeDelete(main);
+#else
+  const Value res = vmRunFunction(mainVariable->value->metadata, NULL, 0);
+  threadDestroy();
+  vmDestroy();
+  const bool ret = res.tag == VALUE_TAG_VOID;
+  valueDelete(res);
+#endif
+  ffiDestroy();
   return ret;
 }
 
-AstTree *runAstTreeFunction(AstTree *tree, AstTree **arguments,
+// constant functions are called by reference unless a call of them is
+// already running, which means the variables of the body are in use
+static AstTreeFunction *runnerBorrowVariable(AstTreeVariable *variable) {
+  if (variable->isConst && !variable->isLazy && variable->value != NULL &&
+      variable->value->token == AST_TREE_TOKEN_FUNCTION) {
+    AstTreeFunction *function = threadFunction(variable->value->metadata);
+    if (function->running == 0) {
+      return function;
+    }
+  }
+  return NULL;
+}
+
+// same as runnerBorrowVariable but also calls the instantiations of shape
+// shifters in place
+static AstTreeFunction *runnerBorrowFunction(AstTree *callee) {
+  if (callee->token == AST_TREE_TOKEN_VARIABLE) {
+    return runnerBorrowVariable(callee->metadata);
+  } else if (callee->token == AST_TREE_TOKEN_SHAPE_SHIFTER_ELEMENT) {
+    AstTreeShapeShifterElement *metadata = callee->metadata;
+    if (metadata->shapeShifter->token != AST_TREE_TOKEN_VARIABLE) {
+      return NULL;
+    }
+    AstTreeVariable *variable = metadata->shapeShifter->metadata;
+    if (variable->value == NULL ||
+        variable->value->token != AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER) {
+      return NULL;
+    }
+    AstTreeShapeShifter *shapeShifter = variable->value->metadata;
+    AstTreeFunction *function =
+        threadFunction(shapeShifter->generateds.functions[metadata->index]);
+    if (function->running == 0) {
+      return function;
+    }
+  }
+  return NULL;
+}
+
+// counts of @stackAlloc and @heapAlloc, signed ones are read by the width of
+// their type since only those bits are kept exactly
+static size_t runnerAllocCount(AstTree *count) {
+  i64 value;
+  switch (count->type->token) {
+  case AST_TREE_TOKEN_TYPE_I8:
+    value = *(i8 *)count->metadata;
+    break;
+  case AST_TREE_TOKEN_TYPE_I16:
+    value = *(i16 *)count->metadata;
+    break;
+  case AST_TREE_TOKEN_TYPE_I32:
+    value = *(i32 *)count->metadata;
+    break;
+  case AST_TREE_TOKEN_TYPE_I64:
+    value = *(i64 *)count->metadata;
+    break;
+  case AST_TREE_TOKEN_TYPE_U8:
+    return *(u8 *)count->metadata;
+  case AST_TREE_TOKEN_TYPE_U16:
+    return *(u16 *)count->metadata;
+  case AST_TREE_TOKEN_TYPE_U32:
+    return *(u32 *)count->metadata;
+  case AST_TREE_TOKEN_TYPE_U64:
+    return *(u64 *)count->metadata;
+  default:
+    UNREACHABLE;
+  }
+  if (value < 0) {
+    printLog("Can't allocate %lld elements", (long long)value);
+    UNREACHABLE;
+  }
+  return value;
+}
+
+void runnerCheckWritable(const AstTreeRawValue *raw) {
+  // writes to a file are mistakes of the program, not of the runner
+  if (fileIsMapped(raw->data)) {
+    printLog("Memory of @mapFile can't be written");
+    exit(1);
+  }
+}
+
+void runnerCheckFrameEscape(AstTree *ret, FrameMark mark) {
+  if (ret->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED &&
+      a404m_frame_owns(mark, ((AstTreeRawValue *)ret->metadata)->data)) {
+    printLog("Memory of @stackAlloc can't be returned from its function");
+    UNREACHABLE;
+  }
+}
+
+AstTree *runAstTreeFunction(AstTreeFunction *function, AstTree **arguments,
                             size_t arguments_size, bool isComptime) {
-  AstTreeFunction *function = tree->metadata;
 
   for (size_t i = 0; i < arguments_size; ++i) {
     AstTree *param = arguments[i];
@@ -104,24 +619,43 @@ AstTree *runAstTreeFunction(AstTree *tree, AstTree **arguments,
   u32 breakCount = 0;
   bool shouldContinue = false;
 
+  // temporaries of leaf calls are freed at once when they return
+  if (function->isLeaf) {
+    a404m_arena_open();
+  }
+
+  // @stackAlloc of this call is released when it returns
+  const FrameMark frameMark = a404m_frame_mark();
+
+  AstTree *ret = &AST_TREE_VOID_VALUE;
+  function->running += 1;
   for (size_t i = 0; i < function->scope.expressions_size; ++i) {
-    AstTree *ret = runExpression(function->scope.expressions[i],
-                                 &function->scope, &shouldRet, false,
-                                 isComptime, &breakCount, &shouldContinue);
+    ret = runExpression(function->scope.expressions[i], &function->scope,
+                        &shouldRet, false, isComptime, &breakCount,
+                        &shouldContinue);
     if (shouldRet) {
-      return ret;
+      break;
     } else {
       astTreeDelete(ret);
+      ret = &AST_TREE_VOID_VALUE;
     }
   }
+  function->running -= 1;
+  runnerCheckFrameEscape(ret, frameMark);
+  a404m_frame_release(frameMark);
 
-  return &AST_TREE_VOID_VALUE;
+  if (function->isLeaf) {
+    ret = runnerArenaEscape(ret);
+    a404m_arena_close();
+  }
+
+  return ret;
 }
 
-AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
-                           AstTree **arguments) {
+AstTree *runAstTreeBuiltin(AstTreeToken token, AstTreeScope *scope,
+                           AstTree **arguments, size_t arguments_size) {
   (void)scope;
-  switch (tree->token) {
+  switch (token) {
   case AST_TREE_TOKEN_BUILTIN_CAST: {
     AstTree *from = arguments[0];
     AstTree *to = arguments[1];
@@ -129,69 +663,69 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     if (from->token == AST_TREE_TOKEN_VALUE_INT) {
       AstTreeInt value = *(AstTreeInt *)from->metadata;
       if (typeIsEqual(to, &AST_TREE_U8_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u8)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue, &AST_TREE_U8_TYPE,
                           NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U16_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U16_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U32_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U64_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U64_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I8_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i8)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue, &AST_TREE_I8_TYPE,
                           NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I16_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I16_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I32_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I64_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I64_TYPE, NULL, NULL);
 #ifdef FLOAT_16_SUPPORT
       } else if (typeIsEqual(to, &AST_TREE_F16_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F16_TYPE, NULL, NULL);
 #endif
       } else if (typeIsEqual(to, &AST_TREE_F32_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_F64_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F64_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_F128_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f128)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F128_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_BOOL_TYPE)) {
-        AstTreeBool *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeBool *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (bool)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_BOOL, newValue,
                           &AST_TREE_BOOL_TYPE, NULL, NULL);
@@ -203,69 +737,69 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     } else if (from->token == AST_TREE_TOKEN_VALUE_FLOAT) {
       AstTreeFloat value = *(AstTreeFloat *)from->metadata;
       if (typeIsEqual(to, &AST_TREE_U8_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u8)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue, &AST_TREE_U8_TYPE,
                           NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U16_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U16_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U32_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U64_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U64_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I8_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i8)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue, &AST_TREE_I8_TYPE,
                           NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I16_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I16_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I32_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I64_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I64_TYPE, NULL, NULL);
 #ifdef FLOAT_16_SUPPORT
       } else if (typeIsEqual(to, &AST_TREE_F16_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F16_TYPE, NULL, NULL);
 #endif
       } else if (typeIsEqual(to, &AST_TREE_F32_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_F64_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F64_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_F128_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f128)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F128_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_BOOL_TYPE)) {
-        AstTreeBool *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeBool *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (bool)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_BOOL, newValue,
                           &AST_TREE_BOOL_TYPE, NULL, NULL);
@@ -277,69 +811,69 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     } else if (from->token == AST_TREE_TOKEN_VALUE_BOOL) {
       AstTreeBool value = *(AstTreeBool *)from->metadata;
       if (typeIsEqual(to, &AST_TREE_U8_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u8)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue, &AST_TREE_U8_TYPE,
                           NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U16_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U16_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U32_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_U64_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (u64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_U64_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I8_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i8)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue, &AST_TREE_I8_TYPE,
                           NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I16_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I16_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I32_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_I64_TYPE)) {
-        AstTreeInt *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeInt *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (i64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_INT, newValue,
                           &AST_TREE_I64_TYPE, NULL, NULL);
 #ifdef FLOAT_16_SUPPORT
       } else if (typeIsEqual(to, &AST_TREE_F16_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f16)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F16_TYPE, NULL, NULL);
 #endif
       } else if (typeIsEqual(to, &AST_TREE_F32_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f32)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F32_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_F64_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f64)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F64_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_F128_TYPE)) {
-        AstTreeFloat *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeFloat *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (f128)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, newValue,
                           &AST_TREE_F128_TYPE, NULL, NULL);
       } else if (typeIsEqual(to, &AST_TREE_BOOL_TYPE)) {
-        AstTreeBool *newValue = a404m_malloc(sizeof(*newValue));
+        AstTreeBool *newValue = a404m_slab_malloc(sizeof(*newValue));
         *newValue = (bool)value;
         return newAstTree(AST_TREE_TOKEN_VALUE_BOOL, newValue,
                           &AST_TREE_BOOL_TYPE, NULL, NULL);
@@ -638,9 +1172,9 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     AstTree *left = arguments[0];
     AstTree *right = arguments[1];
 
-    AstTree *ret =
-        newAstTree(AST_TREE_TOKEN_VALUE_BOOL, a404m_malloc(sizeof(AstTreeBool)),
-                   &AST_TREE_BOOL_TYPE, NULL, NULL);
+    AstTree *ret = newAstTree(AST_TREE_TOKEN_VALUE_BOOL,
+                              a404m_slab_malloc(sizeof(AstTreeBool)),
+                              &AST_TREE_BOOL_TYPE, NULL, NULL);
 
     switch (left->type->token) {
     case AST_TREE_TOKEN_TYPE_I8:
@@ -709,9 +1243,9 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     AstTree *left = arguments[0];
     AstTree *right = arguments[1];
 
-    AstTree *ret =
-        newAstTree(AST_TREE_TOKEN_VALUE_BOOL, a404m_malloc(sizeof(AstTreeBool)),
-                   &AST_TREE_BOOL_TYPE, NULL, NULL);
+    AstTree *ret = newAstTree(AST_TREE_TOKEN_VALUE_BOOL,
+                              a404m_slab_malloc(sizeof(AstTreeBool)),
+                              &AST_TREE_BOOL_TYPE, NULL, NULL);
 
     switch (left->type->token) {
     case AST_TREE_TOKEN_TYPE_I8:
@@ -766,7 +1300,7 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
       break;
     case AST_TREE_TOKEN_TYPE_BOOL:
       *(AstTreeBool *)ret->metadata =
-          *(AstTreeBool *)left->metadata == *(AstTreeBool *)right->metadata;
+          *(AstTreeBool *)left->metadata != *(AstTreeBool *)right->metadata;
       break;
     case AST_TREE_TOKEN_TYPE_TYPE:
       *(AstTreeBool *)ret->metadata = !typeIsEqual(left, right);
@@ -780,9 +1314,9 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     AstTree *left = arguments[0];
     AstTree *right = arguments[1];
 
-    AstTree *ret =
-        newAstTree(AST_TREE_TOKEN_VALUE_BOOL, a404m_malloc(sizeof(AstTreeBool)),
-                   &AST_TREE_BOOL_TYPE, NULL, NULL);
+    AstTree *ret = newAstTree(AST_TREE_TOKEN_VALUE_BOOL,
+                              a404m_slab_malloc(sizeof(AstTreeBool)),
+                              &AST_TREE_BOOL_TYPE, NULL, NULL);
 
     switch (left->type->token) {
     case AST_TREE_TOKEN_TYPE_I8:
@@ -844,9 +1378,9 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     AstTree *left = arguments[0];
     AstTree *right = arguments[1];
 
-    AstTree *ret =
-        newAstTree(AST_TREE_TOKEN_VALUE_BOOL, a404m_malloc(sizeof(AstTreeBool)),
-                   &AST_TREE_BOOL_TYPE, NULL, NULL);
+    AstTree *ret = newAstTree(AST_TREE_TOKEN_VALUE_BOOL,
+                              a404m_slab_malloc(sizeof(AstTreeBool)),
+                              &AST_TREE_BOOL_TYPE, NULL, NULL);
 
     switch (left->type->token) {
     case AST_TREE_TOKEN_TYPE_I8:
@@ -908,9 +1442,9 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     AstTree *left = arguments[0];
     AstTree *right = arguments[1];
 
-    AstTree *ret =
-        newAstTree(AST_TREE_TOKEN_VALUE_BOOL, a404m_malloc(sizeof(AstTreeBool)),
-                   &AST_TREE_BOOL_TYPE, NULL, NULL);
+    AstTree *ret = newAstTree(AST_TREE_TOKEN_VALUE_BOOL,
+                              a404m_slab_malloc(sizeof(AstTreeBool)),
+                              &AST_TREE_BOOL_TYPE, NULL, NULL);
 
     switch (left->type->token) {
     case AST_TREE_TOKEN_TYPE_I8:
@@ -976,9 +1510,9 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     AstTree *left = arguments[0];
     AstTree *right = arguments[1];
 
-    AstTree *ret =
-        newAstTree(AST_TREE_TOKEN_VALUE_BOOL, a404m_malloc(sizeof(AstTreeBool)),
-                   &AST_TREE_BOOL_TYPE, NULL, NULL);
+    AstTree *ret = newAstTree(AST_TREE_TOKEN_VALUE_BOOL,
+                              a404m_slab_malloc(sizeof(AstTreeBool)),
+                              &AST_TREE_BOOL_TYPE, NULL, NULL);
 
     switch (left->type->token) {
     case AST_TREE_TOKEN_TYPE_I8:
@@ -1040,12 +1574,203 @@ AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
     }
     return ret;
   }
+  case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC: {
+    AstTree *type = arguments[0];
+    if (!isRawType(type)) {
+      printLog("Only flat types can be allocated");
+      UNREACHABLE;
+    }
+
+    AstTreeRawValue *metadata = a404m_malloc(sizeof(*metadata));
+    if (__builtin_mul_overflow(runnerAllocCount(arguments[1]),
+                               getSizeOfType(type), &metadata->size) ||
+        metadata->size > PTRDIFF_MAX) {
+      printLog("Allocation is too big");
+      UNREACHABLE;
+    }
+    if (token == AST_TREE_TOKEN_BUILTIN_STACK_ALLOC) {
+      metadata->data = a404m_frame_alloc(metadata->size);
+      memset(metadata->data, 0, metadata->size);
+    } else {
+      metadata->data = a404m_heap_malloc(metadata->size);
+    }
+
+    AstTreeBracket *type_metadata = a404m_malloc(sizeof(*type_metadata));
+    type_metadata->operand = copyAstTree(type);
+    type_metadata->parameters.data = NULL;
+    type_metadata->parameters.size = 0;
+
+    return newAstTree(AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED, metadata,
+                      newAstTree(AST_TREE_TOKEN_TYPE_ARRAY, type_metadata,
+                                 &AST_TREE_TYPE_TYPE, NULL, NULL),
+                      NULL, NULL);
+  }
+  case AST_TREE_TOKEN_BUILTIN_FREE: {
+    AstTree *slice = arguments[0];
+    if (slice->token != AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED ||
+        !a404m_heap_free(((AstTreeRawValue *)slice->metadata)->data)) {
+      printLog("Only memory of @heapAlloc can be freed");
+      UNREACHABLE;
+    }
+    return &AST_TREE_VOID_VALUE;
+  }
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+    return ffiCall(arguments, arguments_size);
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+    return threadSpawn(arguments, arguments_size);
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+    threadJoin(arguments);
+    return &AST_TREE_VOID_VALUE;
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+    return threadAtomic(token, arguments);
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+    threadParallelFor(arguments, arguments_size);
+    return &AST_TREE_VOID_VALUE;
+  case AST_TREE_TOKEN_BUILTIN_GETC: {
+    AstTreeInt *value = a404m_slab_malloc(sizeof(*value));
+    *value = (i64)inputGetc();
+    return newAstTree(AST_TREE_TOKEN_VALUE_INT, value,
+                      copyAstTree(&AST_TREE_I32_TYPE), NULL, NULL);
+  }
+  case AST_TREE_TOKEN_BUILTIN_READ: {
+    AstTreeRawValue *raw = runnerMemoryDestination(&arguments[0]);
+    AstTreeInt *value = a404m_slab_malloc(sizeof(*value));
+    *value = inputRead(raw->data, raw->size);
+    return newAstTree(AST_TREE_TOKEN_VALUE_INT, value,
+                      copyAstTree(&AST_TREE_U64_TYPE), NULL, NULL);
+  }
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE: {
+    AstTreeRawValue *path_raw = arguments[0]->metadata;
+    char *path = a404m_malloc(path_raw->size + 1);
+    memcpy(path, path_raw->data, path_raw->size);
+    path[path_raw->size] = '\0';
+
+    AstTreeRawValue *metadata = a404m_malloc(sizeof(*metadata));
+    if (!fileMap(path, &metadata->data, &metadata->size)) {
+      // files that can't be read are empty for the program to check
+      metadata->data = NULL;
+      metadata->size = 0;
+    }
+    free(path);
+
+    AstTreeBracket *type_metadata = a404m_malloc(sizeof(*type_metadata));
+    type_metadata->operand = copyAstTree(&AST_TREE_U8_TYPE);
+    type_metadata->parameters.data = NULL;
+    type_metadata->parameters.size = 0;
+
+    // the runner reads the pages of the file, they are not copied and they
+    // can't be written
+    return newAstTree(AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED, metadata,
+                      newAstTree(AST_TREE_TOKEN_TYPE_ARRAY, type_metadata,
+                                 &AST_TREE_TYPE_TYPE, NULL, NULL),
+                      NULL, NULL);
+  }
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE: {
+    AstTree *slice = arguments[0];
+    if (slice->token != AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED ||
+        !fileUnmap(((AstTreeRawValue *)slice->metadata)->data)) {
+      printLog("Only memory of @mapFile can be unmapped");
+      UNREACHABLE;
+    }
+    return &AST_TREE_VOID_VALUE;
+  }
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY: {
+    AstTreeRawValue *destination = runnerMemoryDestination(&arguments[0]);
+    AstTreeRawValue *source = runnerMemorySource(arguments[1]);
+    if (destination->size < source->size) {
+      printLog("Destination is too small %zu < %zu", destination->size,
+               source->size);
+      UNREACHABLE;
+    }
+    // a slice can be given as both
+    memmove(destination->data, source->data, source->size);
+    return &AST_TREE_VOID_VALUE;
+  }
+  case AST_TREE_TOKEN_BUILTIN_MEMSET: {
+    AstTreeRawValue *destination = runnerMemoryDestination(&arguments[0]);
+    const size_t size = getSizeOfType(arguments[1]->type);
+    if (destination->size < size) {
+      return &AST_TREE_VOID_VALUE;
+    }
+    valueStoreRaw(valueCopyFromTree(arguments[1]), destination->data);
+
+    bool isByte = true;
+    for (size_t i = 1; i < size; ++i) {
+      if (destination->data[i] != destination->data[0]) {
+        isByte = false;
+        break;
+      }
+    }
+    if (isByte) {
+      memset(destination->data, destination->data[0], destination->size);
+    } else {
+      // the filled part is copied after itself until it fills all of it
+      size_t filled = size;
+      while (filled < destination->size) {
+        size_t count = destination->size - filled;
+        if (count > filled) {
+          count = filled;
+        }
+        memcpy(destination->data + filled, destination->data, count);
+        filled += count;
+      }
+    }
+    return &AST_TREE_VOID_VALUE;
+  }
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP: {
+    AstTreeRawValue *left = runnerMemorySource(arguments[0]);
+    AstTreeRawValue *right = runnerMemorySource(arguments[1]);
+    const size_t size = left->size < right->size ? left->size : right->size;
+    int res = memcmp(left->data, right->data, size);
+    if (res == 0) {
+      // the shorter one is smaller like strings
+      res = (left->size > right->size) - (left->size < right->size);
+    }
+    AstTreeInt *value = a404m_slab_malloc(sizeof(*value));
+    *value = (i64)((res > 0) - (res < 0));
+    return newAstTree(AST_TREE_TOKEN_VALUE_INT, value,
+                      copyAstTree(&AST_TREE_I32_TYPE), NULL, NULL);
+  }
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
+    return reduceRun(token, arguments);
   case AST_TREE_TOKEN_BUILTIN_IMPORT:
   default:
   }
   UNREACHABLE;
 }
 
+// operators whose overload only forwards to a builtin run the kernel without
+// calling the overload
+static AstTree *runOperatorBuiltin(AstTreeToken builtin, AstTree **arguments,
+                                   size_t arguments_size, AstTreeScope *scope,
+                                   bool *shouldRet, bool isComptime,
+                                   u32 *breakCount, bool *shouldContinue) {
+  for (size_t i = 0; i < arguments_size; ++i) {
+    arguments[i] =
+        getForVariable(arguments[i], scope, shouldRet, false, isComptime,
+                       breakCount, shouldContinue, NULL);
+    if (discontinue(*shouldRet, *breakCount)) {
+      for (size_t j = 0; j < i; ++j) {
+        astTreeDelete(arguments[j]);
+      }
+      return arguments[i];
+    }
+  }
+  AstTree *ret =
+      runAstTreeBuiltin(builtin, scope, arguments, arguments_size);
+  for (size_t i = 0; i < arguments_size; ++i) {
+    astTreeDelete(arguments[i]);
+  }
+  return ret;
+}
+
 AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
                        bool isLeft, bool isComptime, u32 *breakCount,
                        bool *shouldContinue) {
@@ -1057,51 +1782,62 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
     if (discontinue(*shouldRet, *breakCount)) {
       return tree;
     }
-    putchar((u8) * (AstTreeInt *)tree->metadata);
+    outputPutc((u8) * (AstTreeInt *)tree->metadata);
     astTreeDelete(tree);
     return &AST_TREE_VOID_VALUE;
   }
   case AST_TREE_TOKEN_FUNCTION_CALL: {
     AstTreeFunctionCall *metadata = expr->metadata;
-    AstTree *function =
-        runExpression(metadata->function, scope, shouldRet, false, isComptime,
-                      breakCount, shouldContinue);
-    if (discontinue(*shouldRet, *breakCount)) {
-      return function;
+    AstTreeFunction *fun = runnerBorrowFunction(metadata->function);
+    // only set when the callee can't be borrowed
+    AstTree *function = NULL;
+    if (fun == NULL) {
+      function = runExpression(metadata->function, scope, shouldRet, false,
+                               isComptime, breakCount, shouldContinue);
+      if (discontinue(*shouldRet, *breakCount)) {
+        return function;
+      }
+      if (function->token == AST_TREE_TOKEN_FUNCTION) {
+        fun = function->metadata;
+      }
     }
 
     const size_t args_size = metadata->parameters_size;
     AstTree *args[args_size];
 
     AstTree *result;
-    if (function->token == AST_TREE_TOKEN_FUNCTION) {
-      AstTreeFunction *fun = function->metadata;
-
+    if (fun != NULL) {
       for (size_t i = 0; i < args_size; ++i) {
         AstTreeVariable *function_arg = fun->arguments.data[i];
         AstTreeFunctionCallParam param = metadata->parameters[i];
         args[i] =
             getForVariable(param.value, scope, shouldRet, false, isComptime,
-                           breakCount, shouldContinue, function_arg->isLazy);
+                           breakCount, shouldContinue, function_arg);
         if (discontinue(*shouldRet, *breakCount)) {
-          astTreeDelete(function);
+          if (function != NULL) {
+            astTreeDelete(function);
+          }
           for (size_t j = 0; j < i; ++j) {
             astTreeDelete(args[i]);
           }
           return args[i];
         }
       }
-      result = runAstTreeFunction(function, args, args_size, isComptime);
+      result = runAstTreeFunction(fun, args, args_size, isComptime);
     } else if (function->token >= AST_TREE_TOKEN_BUILTIN_BEGIN &&
                function->token <= AST_TREE_TOKEN_BUILTIN_END) {
       for (size_t i = 0; i < args_size; ++i) {
         AstTreeFunctionCallParam param = metadata->parameters[i];
         if (function->token != AST_TREE_TOKEN_BUILTIN_TYPE_OF) {
+          const bool isLeft =
+              runnerIsMemoryDestination(function->token, i, param.value);
           args[i] =
-              getForVariable(param.value, scope, shouldRet, false, isComptime,
-                             breakCount, shouldContinue, false);
+              getForVariable(param.value, scope, shouldRet, isLeft,
+                             isComptime, breakCount, shouldContinue, NULL);
           if (discontinue(*shouldRet, *breakCount)) {
-            astTreeDelete(function);
+            if (function != NULL) {
+              astTreeDelete(function);
+            }
             for (size_t j = 0; j < i; ++j) {
               astTreeDelete(args[i]);
             }
@@ -1111,7 +1847,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
           args[i] = param.value;
         }
       }
-      result = runAstTreeBuiltin(function, scope, args);
+      result = runAstTreeBuiltin(function->token, scope, args, args_size);
       if (function->token != AST_TREE_TOKEN_BUILTIN_TYPE_OF) {
         for (size_t i = 0; i < args_size; ++i) {
           astTreeDelete(args[i]);
@@ -1121,7 +1857,9 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
       UNREACHABLE;
     }
 
-    astTreeDelete(function);
+    if (function != NULL) {
+      astTreeDelete(function);
+    }
     return result;
   }
   case AST_TREE_TOKEN_OPERATOR_ASSIGN: {
@@ -1131,25 +1869,35 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
     if (discontinue(*shouldRet, *breakCount)) {
       return l;
     }
-    if (l->token != AST_TREE_TOKEN_VARIABLE) {
+    if (l->token != AST_TREE_TOKEN_VARIABLE &&
+        l->token != AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
       UNREACHABLE;
     }
-    AstTreeVariable *left = l->metadata;
     AstTree *right = runExpression(metadata->right, scope, shouldRet, false,
                                    isComptime, breakCount, shouldContinue);
     if (discontinue(*shouldRet, *breakCount)) {
       astTreeDelete(l);
       return right;
     }
+    if (l->token == AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED) {
+      AstTreeRawValue *raw = l->metadata;
+      valueStoreRaw(valueCopyFromTree(right), raw->data);
+      astTreeDelete(l);
+      return right;
+    }
+    AstTreeVariable *left = l->metadata;
     runnerVariableSetValue(left, right);
     astTreeDelete(l);
-    return copyAstTree(left->value);
+    return runnerVariableGetValue(left);
   }
   case AST_TREE_TOKEN_KEYWORD_RETURN: {
     AstTreeReturn *metadata = expr->metadata;
     if (metadata->value != NULL) {
+      // the returned value outlives the arena of a leaf call
+      const bool wasOpen = a404m_arena_pause();
       AstTree *ret = runExpression(metadata->value, scope, shouldRet, false,
                                    isComptime, breakCount, shouldContinue);
+      a404m_arena_resume(wasOpen);
       *shouldRet = true;
       return ret;
     } else {
@@ -1161,7 +1909,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
     AstTreeVariable *variable = expr->metadata;
     AstTree *value;
     if (variable->isLazy) {
-      value = copyAstTree(variable->initValue);
+      value = runnerThunk(variable->initValue, variable->isByName);
     } else {
       value = runExpression(variable->initValue, scope, shouldRet, false,
                             isComptime, breakCount, shouldContinue);
@@ -1199,6 +1947,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
     AstTree *ret = &AST_TREE_VOID_VALUE;
     while (!*shouldRet) {
       astTreeDelete(ret);
+      ret = &AST_TREE_VOID_VALUE;
       AstTree *condition =
           runExpression(metadata->condition, scope, shouldRet, false,
                         isComptime, breakCount, shouldContinue);
@@ -1249,14 +1998,21 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
   case AST_TREE_TOKEN_OPERATOR_MINUS:
   case AST_TREE_TOKEN_OPERATOR_PLUS: {
     AstTreeUnary *metadata = expr->metadata;
-    AstTree *function =
-        runExpression(metadata->function->value, scope, shouldRet, false,
-                      isComptime, breakCount, shouldContinue);
-    if (discontinue(*shouldRet, *breakCount)) {
-      return function;
+    if (metadata->builtin != AST_TREE_TOKEN_NONE) {
+      AstTree *arguments[] = {
+          metadata->operand,
+      };
+      return runOperatorBuiltin(metadata->builtin, arguments, 1, scope,
+                                shouldRet, isComptime, breakCount,
+                                shouldContinue);
+    }
+    AstTreeFunction *fun = runnerBorrowVariable(metadata->function);
+    // only set when the overload can't be borrowed
+    AstTree *function = NULL;
+    if (fun == NULL) {
+      function = threadCopyFunction(metadata->function->value);
+      fun = function->metadata;
     }
-
-    AstTreeFunction *fun = function->metadata;
 
     AstTree *arguments[] = {
         metadata->operand,
@@ -1266,9 +2022,11 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
       AstTreeVariable *arg = fun->arguments.data[i];
       arguments[i] =
           getForVariable(arguments[i], scope, shouldRet, isLeft, isComptime,
-                         breakCount, shouldContinue, arg->isLazy);
+                         breakCount, shouldContinue, arg);
       if (discontinue(*shouldRet, *breakCount)) {
-        astTreeDelete(function);
+        if (function != NULL) {
+          astTreeDelete(function);
+        }
         for (size_t j = 0; j < i; ++j) {
           astTreeDelete(arguments[j]);
         }
@@ -1276,8 +2034,10 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
       }
     }
 
-    AstTree *ret = runAstTreeFunction(function, arguments, 1, isComptime);
-    astTreeDelete(function);
+    AstTree *ret = runAstTreeFunction(fun, arguments, 1, isComptime);
+    if (function != NULL) {
+      astTreeDelete(function);
+    }
     return ret;
   }
   case AST_TREE_TOKEN_OPERATOR_SUM:
@@ -1294,14 +2054,38 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
   case AST_TREE_TOKEN_OPERATOR_LOGICAL_AND:
   case AST_TREE_TOKEN_OPERATOR_LOGICAL_OR: {
     AstTreeInfix *metadata = expr->metadata;
-    AstTree *function =
-        runExpression(metadata->function->value, scope, shouldRet, false,
-                      isComptime, breakCount, shouldContinue);
-    if (discontinue(*shouldRet, *breakCount)) {
-      return function;
+    if (metadata->builtin == expr->token) {
+      AstTree *left =
+          runExpression(metadata->left, scope, shouldRet, false, isComptime,
+                        breakCount, shouldContinue);
+      if (discontinue(*shouldRet, *breakCount)) {
+        return left;
+      } else if (left->token != AST_TREE_TOKEN_VALUE_BOOL) {
+        UNREACHABLE;
+      }
+      if (*(AstTreeBool *)left->metadata ==
+          (expr->token == AST_TREE_TOKEN_OPERATOR_LOGICAL_OR)) {
+        return left;
+      }
+      astTreeDelete(left);
+      return runExpression(metadata->right, scope, shouldRet, false,
+                           isComptime, breakCount, shouldContinue);
+    } else if (metadata->builtin != AST_TREE_TOKEN_NONE) {
+      AstTree *arguments[] = {
+          metadata->left,
+          metadata->right,
+      };
+      return runOperatorBuiltin(metadata->builtin, arguments, 2, scope,
+                                shouldRet, isComptime, breakCount,
+                                shouldContinue);
+    }
+    AstTreeFunction *fun = runnerBorrowVariable(metadata->function);
+    // only set when the overload can't be borrowed
+    AstTree *function = NULL;
+    if (fun == NULL) {
+      function = threadCopyFunction(metadata->function->value);
+      fun = function->metadata;
     }
-
-    AstTreeFunction *fun = function->metadata;
 
     AstTree *arguments[] = {
         metadata->left,
@@ -1312,9 +2096,11 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
       AstTreeVariable *arg = fun->arguments.data[i];
       arguments[i] =
           getForVariable(arguments[i], scope, shouldRet, isLeft, isComptime,
-                         breakCount, shouldContinue, arg->isLazy);
+                         breakCount, shouldContinue, arg);
       if (discontinue(*shouldRet, *breakCount)) {
-        astTreeDelete(function);
+        if (function != NULL) {
+          astTreeDelete(function);
+        }
         for (size_t j = 0; j < i; ++j) {
           astTreeDelete(arguments[j]);
         }
@@ -1322,8 +2108,10 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
       }
     }
 
-    AstTree *ret = runAstTreeFunction(function, arguments, 2, isComptime);
-    astTreeDelete(function);
+    AstTree *ret = runAstTreeFunction(fun, arguments, 2, isComptime);
+    if (function != NULL) {
+      astTreeDelete(function);
+    }
     return ret;
   }
   case AST_TREE_TOKEN_TYPE_TYPE:
@@ -1355,6 +2143,8 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
   case AST_TREE_TOKEN_VALUE_BOOL:
   case AST_TREE_TOKEN_VALUE_FLOAT:
   case AST_TREE_TOKEN_VALUE_OBJECT:
+  case AST_TREE_TOKEN_RAW_VALUE:
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
   case AST_TREE_TOKEN_FUNCTION:
   case AST_TREE_TOKEN_TYPE_ARRAY:
   case AST_TREE_TOKEN_BUILTIN_CAST:
@@ -1362,6 +2152,26 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
   case AST_TREE_TOKEN_BUILTIN_IMPORT:
   case AST_TREE_TOKEN_BUILTIN_STACK_ALLOC:
   case AST_TREE_TOKEN_BUILTIN_HEAP_ALLOC:
+  case AST_TREE_TOKEN_BUILTIN_FREE:
+  case AST_TREE_TOKEN_BUILTIN_FFI:
+  case AST_TREE_TOKEN_BUILTIN_SPAWN:
+  case AST_TREE_TOKEN_BUILTIN_JOIN:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE:
+  case AST_TREE_TOKEN_BUILTIN_PARALLEL_FOR:
+  case AST_TREE_TOKEN_BUILTIN_GETC:
+  case AST_TREE_TOKEN_BUILTIN_READ:
+  case AST_TREE_TOKEN_BUILTIN_MAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_UNMAP_FILE:
+  case AST_TREE_TOKEN_BUILTIN_MEMCPY:
+  case AST_TREE_TOKEN_BUILTIN_MEMSET:
+  case AST_TREE_TOKEN_BUILTIN_MEMCMP:
+  case AST_TREE_TOKEN_BUILTIN_SUM:
+  case AST_TREE_TOKEN_BUILTIN_MIN:
+  case AST_TREE_TOKEN_BUILTIN_MAX:
+  case AST_TREE_TOKEN_BUILTIN_DOT:
   case AST_TREE_TOKEN_BUILTIN_NEG:
   case AST_TREE_TOKEN_BUILTIN_ADD:
   case AST_TREE_TOKEN_BUILTIN_SUB:
@@ -1376,7 +2186,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
   case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
     return copyAstTree(expr);
   case AST_TREE_TOKEN_BUILTIN_IS_COMPTIME: {
-    AstTreeBool *metadata = a404m_malloc(sizeof(*metadata));
+    AstTreeBool *metadata = a404m_slab_malloc(sizeof(*metadata));
     *metadata = isComptime;
     return newAstTree(AST_TREE_TOKEN_VALUE_BOOL, metadata,
                       copyAstTree(&AST_TREE_BOOL_TYPE), expr->str_begin,
@@ -1405,7 +2215,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
       ret = operand;
     } else {
       AstTreeVariable *variable = operand->metadata;
-      ret = copyAstTree(variable->value);
+      ret = runnerVariableGetValue(variable);
       astTreeDelete(operand);
     }
     return ret;
@@ -1415,14 +2225,17 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
     if (isLeft) {
       return copyAstTree(expr);
     } else {
-      if (variable->value == NULL) {
-        UNREACHABLE;
-      }
       if (variable->isLazy) {
+        if (variable->value == NULL) {
+          UNREACHABLE;
+        }
         return runExpression(variable->value, scope, shouldRet, false,
                              isComptime, breakCount, shouldContinue);
+      } else if (variable->isConst &&
+                 variable->value->token == AST_TREE_TOKEN_FUNCTION) {
+        return threadCopyFunction(variable->value);
       } else {
-        return copyAstTree(variable->value);
+        return runnerVariableGetValue(variable);
       }
     }
   }
@@ -1438,68 +2251,20 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
     }
     AstTreeVariable *variable = tree->metadata;
     astTreeDelete(tree);
-    if (variable->type->token == AST_TREE_TOKEN_TYPE_ARRAY) {
-      AstTreeBracket *array_metadata = variable->type->metadata;
-      if (metadata->member.index != 0) {
-        UNREACHABLE;
-      } else if (variable->value->token == AST_TREE_TOKEN_VALUE_UNDEFINED) {
-        if (array_metadata->parameters.size == 0) {
-          UNREACHABLE;
-        } else {
-          AstTree *sizeTree = runExpression(array_metadata->parameters.data[0],
-                                            scope, shouldRet, false, isComptime,
-                                            breakCount, shouldContinue);
-          if (discontinue(*shouldRet, *breakCount)) {
-            return sizeTree;
-          }
-          if (sizeTree->token != AST_TREE_TOKEN_VALUE_INT) {
-            UNREACHABLE;
-          } else {
-            return sizeTree;
-          }
-        }
-      } else if (variable->value->token == AST_TREE_TOKEN_VALUE_OBJECT) {
-        AstTreeObject *object = variable->value->metadata;
-        AstTreeInt *res_metadata = a404m_malloc(sizeof(*res_metadata));
-        *res_metadata = object->variables.size;
-        return newAstTree(AST_TREE_TOKEN_VALUE_INT, res_metadata,
-                          &AST_TREE_U64_TYPE, NULL, NULL);
-      }
-    } else if (variable->type->token == AST_TREE_TOKEN_KEYWORD_STRUCT) {
-      if (variable->value->token == AST_TREE_TOKEN_VALUE_UNDEFINED) {
-        AstTreeStruct *struc = variable->type->metadata;
-        AstTreeObject *newMetadata = a404m_malloc(sizeof(*newMetadata));
-
-        newMetadata->variables =
-            copyAstTreeVariables(struc->variables, NULL, NULL, 0, false);
-
-        for (size_t i = 0; i < newMetadata->variables.size; ++i) {
-          AstTreeVariable *member = newMetadata->variables.data[i];
-          if (!member->isConst) {
-            runnerVariableSetValue(member,
-                                   newAstTree(AST_TREE_TOKEN_VALUE_UNDEFINED,
-                                              NULL, copyAstTree(member->type),
-                                              variable->value->str_begin,
-                                              variable->value->str_end));
-          }
-        }
-
-        runnerVariableSetValue(variable, newAstTree(AST_TREE_TOKEN_VALUE_OBJECT,
-                                                    newMetadata,
-                                                    copyAstTree(variable->type),
-                                                    variable->value->str_begin,
-                                                    variable->value->str_end));
-      }
-      AstTreeObject *object = variable->value->metadata;
-      AstTreeVariable *var = object->variables.data[metadata->member.index];
-      if (isLeft) {
-        return newAstTree(AST_TREE_TOKEN_VARIABLE, var, copyAstTree(var->type),
-                          var->name_begin, var->name_end);
-      } else {
-        return copyAstTree(var->value);
-      }
+    return runnerAccessMember(variable, metadata->member.index, isLeft);
+  }
+  case AST_TREE_TOKEN_THUNK: {
+    AstTreeThunk *metadata = expr->metadata;
+    if (metadata->value != NULL) {
+      return copyAstTree(metadata->value);
     }
-    UNREACHABLE;
+    AstTree *value =
+        runExpression(metadata->expr, scope, shouldRet, false, isComptime,
+                      breakCount, shouldContinue);
+    if (!metadata->isByName && !discontinue(*shouldRet, *breakCount)) {
+      metadata->value = copyAstTree(value);
+    }
+    return value;
   }
   case AST_TREE_TOKEN_KEYWORD_STRUCT: {
     expr = copyAstTree(expr);
@@ -1515,6 +2280,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
         return member->type;
       }
     }
+    setStructLayout(metadata);
     return expr;
   }
   case AST_TREE_TOKEN_OPERATOR_POINTER: {
@@ -1560,58 +2326,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
 
     AstTreeVariable *variable = operand->metadata;
     astTreeDelete(operand);
-    if (variable->value->token == AST_TREE_TOKEN_VALUE_UNDEFINED) {
-      AstTreeBracket *array_type_metadata = variable->type->metadata;
-      if (array_type_metadata->parameters.size != 1) {
-        UNREACHABLE;
-      }
-      AstTree *arraySize_tree = runExpression(
-          array_type_metadata->parameters.data[0], scope, shouldRet, false,
-          isComptime, breakCount, shouldContinue);
-      if (discontinue(*shouldRet, *breakCount)) {
-        return arraySize_tree;
-      }
-      if (arraySize_tree->token != AST_TREE_TOKEN_VALUE_INT) {
-        UNREACHABLE;
-      }
-      AstTreeInt array_size = *(AstTreeInt *)arraySize_tree->metadata;
-      astTreeDelete(arraySize_tree);
-
-      AstTreeObject *newMetadata = a404m_malloc(sizeof(*newMetadata));
-
-      newMetadata->variables = (AstTreeVariables){
-          .data =
-              a404m_malloc(array_size * sizeof(*newMetadata->variables.data)),
-          .size = array_size,
-      };
-
-      for (size_t i = 0; i < array_size; ++i) {
-        AstTreeVariable *member = a404m_malloc(sizeof(*member));
-        member->name_begin = member->name_end = NULL;
-        member->isConst = false;
-        member->type = copyAstTree(array_type_metadata->operand);
-        member->value = newAstTree(
-            AST_TREE_TOKEN_VALUE_UNDEFINED, NULL, copyAstTree(member->type),
-            variable->value->str_begin, variable->value->str_end);
-        member->initValue = NULL;
-        newMetadata->variables.data[i] = member;
-      }
-
-      runnerVariableSetValue(variable, newAstTree(AST_TREE_TOKEN_VALUE_OBJECT,
-                                                  newMetadata,
-                                                  copyAstTree(variable->type),
-                                                  variable->value->str_begin,
-                                                  variable->value->str_end));
-    }
-    AstTreeObject *object = variable->value->metadata;
-    AstTreeVariable *var = object->variables.data[index];
-
-    if (isLeft) {
-      return newAstTree(AST_TREE_TOKEN_VARIABLE, var, copyAstTree(var->type),
-                        var->name_begin, var->name_end);
-    } else {
-      return copyAstTree(var->value);
-    }
+    return runnerArrayAccess(variable, index, isLeft);
   }
   case AST_TREE_TOKEN_VALUE_SHAPE_SHIFTER: {
     UNREACHABLE;
@@ -1629,7 +2344,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
 
     AstTreeShapeShifter *shapeShifter = variable->value->metadata;
     AstTreeFunction *function =
-        shapeShifter->generateds.functions[metadata->index];
+        threadFunction(shapeShifter->generateds.functions[metadata->index]);
 
     return newAstTree(AST_TREE_TOKEN_FUNCTION,
                       copyAstTreeFunction(function, NULL, NULL, 0, false),
@@ -1651,17 +2366,28 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
   UNREACHABLE;
 }
 
+// lazy arguments get a thunk of expr instead of its value, argument can be
+// NULL for builtins
 AstTree *getForVariable(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
                         bool isLeft, bool isComptime, u32 *breakCount,
-                        bool *shouldContinue, bool isLazy) {
-  if (isLazy) {
-    return copyAstTree(expr);
+                        bool *shouldContinue, AstTreeVariable *argument) {
+  if (argument != NULL && argument->isLazy) {
+    return runnerThunk(expr, argument->isByName);
   } else {
     return runExpression(expr, scope, shouldRet, isLeft, isComptime, breakCount,
                          shouldContinue);
   }
 }
 
+AstTree *runnerThunk(AstTree *expr, bool isByName) {
+  AstTreeThunk *metadata = a404m_malloc(sizeof(*metadata));
+  metadata->expr = expr;
+  metadata->value = NULL;
+  metadata->isByName = isByName;
+  return newAstTree(AST_TREE_TOKEN_THUNK, metadata, copyAstTree(expr->type),
+                    expr->str_begin, expr->str_end);
+}
+
 bool discontinue(bool shouldRet, u32 breakCount) {
   return shouldRet || breakCount > 0;
 }
@@ -1,19 +1,43 @@
 #pragma once
 
 #include "compiler/ast-tree.h"
+#include "utils/memory.h"
 
 void runnerVariableSetValue(AstTreeVariable *variable, AstTree *value);
+AstTree *runnerArenaEscape(AstTree *value);
 void runnerVariableSetValueWihtoutConstCheck(AstTreeVariable *variable,
                                              AstTree *value);
 AstTree *runnerVariableGetValue(AstTreeVariable *variable);
+u8 *runnerStructRawMember(AstTreeVariable *variable, size_t index,
+                          AstTree **type, bool isLeft);
+void runnerRawUnshare(AstTreeRawValue *raw);
+AstTreeVariable *runnerStructMember(AstTreeVariable *variable, size_t index);
+u8 *runnerArrayRawElement(AstTreeVariable *variable, AstTreeInt index,
+                          AstTree **type, bool isLeft);
+AstTreeVariable *runnerArrayElement(AstTreeVariable *variable,
+                                    AstTreeInt index);
+AstTree *runnerAccessMember(AstTreeVariable *variable, size_t index,
+                            bool isLeft);
+AstTree *runnerArrayAccess(AstTreeVariable *variable, AstTreeInt index,
+                           bool isLeft);
 
 bool runAstTree(AstTreeRoots roots);
 
-AstTree *runAstTreeFunction(AstTree *tree, AstTree **arguments,
+// true if the argument of the builtin is written, it is given as a variable
+bool runnerIsMemoryDestination(AstTreeToken builtin, size_t index,
+                               AstTree *argument);
+
+// fails if the bytes are memory of @mapFile, they are mapped read only
+void runnerCheckWritable(const AstTreeRawValue *raw);
+
+// fails if the returned value is a view of @stackAlloc memory of the frame
+void runnerCheckFrameEscape(AstTree *ret, FrameMark mark);
+
+AstTree *runAstTreeFunction(AstTreeFunction *function, AstTree **arguments,
                             size_t arguments_size, bool isComptime);
 
-AstTree *runAstTreeBuiltin(AstTree *tree, AstTreeScope *scope,
-                           AstTree **arguments);
+AstTree *runAstTreeBuiltin(AstTreeToken token, AstTreeScope *scope,
+                           AstTree **arguments, size_t arguments_size);
 
 AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
                        bool isLeft, bool isComptime, u32 *breakCount,
@@ -21,6 +45,7 @@ AstTree *runExpression(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
 
 AstTree *getForVariable(AstTree *expr, AstTreeScope *scope, bool *shouldRet,
                         bool isLeft, bool isComptime, u32 *breakCount,
-                        bool *shouldContinue, bool isLazy);
+                        bool *shouldContinue, AstTreeVariable *argument);
+AstTree *runnerThunk(AstTree *expr, bool isByName);
 
 bool discontinue(bool shouldRet, u32 breakCount);
@@ -0,0 +1,626 @@
+#include "thread.h"
+
+#include "runner/runner.h"
+#include "runner/vm.h"
+#include "utils/log.h"
+#include "utils/memory.h"
+#include "utils/output.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+typedef struct ThreadStart {
+  AstTree *function;
+  AstTree **arguments;
+  size_t arguments_size;
+} ThreadStart;
+
+// chunks of a @parallelFor per worker at the start, the more there are the
+// better the work is balanced by stealing
+#define THREAD_CHUNKS_PER_WORKER 8
+
+typedef struct ThreadParallel ThreadParallel;
+
+typedef struct ThreadWorker {
+  pthread_t thread;
+  // the chunks that the worker has not run are [begin, end), it runs them
+  // from the begin and others steal them from the end
+  pthread_mutex_t mutex;
+  size_t begin;
+  size_t end;
+  AstTree *function;
+  ThreadParallel *parallel;
+  size_t index;
+} ThreadWorker;
+
+struct ThreadParallel {
+  AstTreeInt begin;
+  AstTreeInt end;
+  // arguments after the index
+  AstTree **arguments;
+  size_t arguments_size;
+  // output of each chunk to be written in the order of the chunks
+  OutputBuffer *outputs;
+  size_t chunks_size;
+  ThreadWorker *workers;
+  size_t workers_size;
+};
+
+typedef struct Thread {
+  pthread_t thread;
+  bool joined;
+} Thread;
+
+// handles are the index in this plus one
+static struct {
+  Thread *data;
+  size_t size;
+} THREADS = {
+    .data = NULL,
+    .size = 0,
+};
+static pthread_mutex_t THREADS_MUTEX = PTHREAD_MUTEX_INITIALIZER;
+
+// spawned threads and workers that have not finished running
+static size_t THREADS_RUNNING = 0;
+
+// recursive since making the value of a global sets the global
+static pthread_mutex_t GLOBALS_MUTEX;
+static pthread_once_t GLOBALS_MUTEX_ONCE = PTHREAD_ONCE_INIT;
+
+// values of globals that were replaced while the globals were shared
+static struct {
+  AstTree **data;
+  size_t size;
+} GLOBALS_RETIRED = {
+    .data = NULL,
+    .size = 0,
+};
+
+typedef struct ThreadFunctionEntry {
+  AstTreeFunction *shared;
+  AstTreeFunction *copy;
+} ThreadFunctionEntry;
+
+// private copies of the shared functions that the thread called
+static _Thread_local struct {
+  ThreadFunctionEntry *data;
+  size_t size;
+  size_t capacity;
+} THREAD_FUNCTIONS = {
+    .data = NULL,
+    .size = 0,
+    .capacity = 0,
+};
+
+static size_t threadFunctionHash(AstTreeFunction *function) {
+  uintptr_t key = (uintptr_t)function;
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return key;
+}
+
+static void threadFunctionInsert(AstTreeFunction *shared,
+                                 AstTreeFunction *copy) {
+  if ((THREAD_FUNCTIONS.size + 1) * 2 > THREAD_FUNCTIONS.capacity) {
+    ThreadFunctionEntry *old = THREAD_FUNCTIONS.data;
+    const size_t old_capacity = THREAD_FUNCTIONS.capacity;
+    THREAD_FUNCTIONS.capacity = old_capacity == 0 ? 16 : old_capacity * 2;
+    THREAD_FUNCTIONS.data = a404m_malloc(THREAD_FUNCTIONS.capacity *
+                                         sizeof(*THREAD_FUNCTIONS.data));
+    for (size_t i = 0; i < THREAD_FUNCTIONS.capacity; ++i) {
+      THREAD_FUNCTIONS.data[i].shared = NULL;
+    }
+    THREAD_FUNCTIONS.size = 0;
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old[i].shared != NULL) {
+        threadFunctionInsert(old[i].shared, old[i].copy);
+      }
+    }
+    free(old);
+  }
+
+  const size_t mask = THREAD_FUNCTIONS.capacity - 1;
+  size_t i = threadFunctionHash(shared) & mask;
+  while (THREAD_FUNCTIONS.data[i].shared != NULL) {
+    i = (i + 1) & mask;
+  }
+  THREAD_FUNCTIONS.data[i].shared = shared;
+  THREAD_FUNCTIONS.data[i].copy = copy;
+  THREAD_FUNCTIONS.size += 1;
+}
+
+AstTreeFunction *threadFunction(AstTreeFunction *function) {
+  // the main thread runs the shared functions themselves
+  if (!AST_TREE_PRIVATE_COPIES || function->isPrivate) {
+    return function;
+  }
+
+  if (THREAD_FUNCTIONS.capacity != 0) {
+    const size_t mask = THREAD_FUNCTIONS.capacity - 1;
+    for (size_t i = threadFunctionHash(function) & mask;
+         THREAD_FUNCTIONS.data[i].shared != NULL; i = (i + 1) & mask) {
+      if (THREAD_FUNCTIONS.data[i].shared == function) {
+        return THREAD_FUNCTIONS.data[i].copy;
+      }
+    }
+  }
+
+  AstTreeFunction *copy = copyAstTreeFunctionForThread(function);
+  threadFunctionInsert(function, copy);
+  return copy;
+}
+
+AstTree *threadCopyFunction(AstTree *function) {
+  if (!AST_TREE_PRIVATE_COPIES) {
+    return copyAstTree(function);
+  }
+  return newAstTree(
+      AST_TREE_TOKEN_FUNCTION,
+      copyAstTreeFunction(threadFunction(function->metadata), NULL, NULL, 0,
+                          false),
+      copyAstTree(function->type), function->str_begin, function->str_end);
+}
+
+static void threadFunctionsDelete() {
+  for (size_t i = 0; i < THREAD_FUNCTIONS.capacity; ++i) {
+    AstTreeFunction *copy = THREAD_FUNCTIONS.data[i].copy;
+    if (THREAD_FUNCTIONS.data[i].shared != NULL) {
+      astTreeFunctionDestroy(*copy);
+      free(copy);
+    }
+  }
+  free(THREAD_FUNCTIONS.data);
+  THREAD_FUNCTIONS.data = NULL;
+  THREAD_FUNCTIONS.size = 0;
+  THREAD_FUNCTIONS.capacity = 0;
+}
+
+bool threadGlobalsShared() {
+  return __atomic_load_n(&THREADS_RUNNING, __ATOMIC_ACQUIRE) != 0;
+}
+
+static void threadGlobalsMutexInit() {
+  pthread_mutexattr_t attributes;
+  pthread_mutexattr_init(&attributes);
+  pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&GLOBALS_MUTEX, &attributes);
+  pthread_mutexattr_destroy(&attributes);
+}
+
+void threadGlobalsLock() {
+  pthread_once(&GLOBALS_MUTEX_ONCE, threadGlobalsMutexInit);
+  pthread_mutex_lock(&GLOBALS_MUTEX);
+}
+
+void threadGlobalsUnlock() { pthread_mutex_unlock(&GLOBALS_MUTEX); }
+
+static bool threadGlobalWriteInPlace(AstTree *old, AstTree *value) {
+  if (old->token != value->token) {
+    return false;
+  }
+  switch (value->token) {
+  case AST_TREE_TOKEN_VALUE_INT:
+    *(AstTreeInt *)old->metadata = *(AstTreeInt *)value->metadata;
+    return true;
+  case AST_TREE_TOKEN_VALUE_FLOAT:
+    *(AstTreeFloat *)old->metadata = *(AstTreeFloat *)value->metadata;
+    return true;
+  case AST_TREE_TOKEN_VALUE_BOOL:
+    *(AstTreeBool *)old->metadata = *(AstTreeBool *)value->metadata;
+    return true;
+  default:
+    return false;
+  }
+}
+
+void threadGlobalSet(AstTreeVariable *variable, AstTree *value) {
+  threadGlobalsLock();
+  AstTree *old = variable->value;
+  if (old != NULL && old != variable->initValue &&
+      threadGlobalWriteInPlace(old, value)) {
+    pthread_mutex_unlock(&GLOBALS_MUTEX);
+    astTreeDelete(value);
+    return;
+  }
+  if (old != NULL) {
+    size_t capacity = a404m_malloc_usable_size(GLOBALS_RETIRED.data) /
+                      sizeof(*GLOBALS_RETIRED.data);
+    if (capacity == GLOBALS_RETIRED.size) {
+      capacity += capacity / 2 + 1;
+      GLOBALS_RETIRED.data = a404m_realloc(
+          GLOBALS_RETIRED.data, capacity * sizeof(*GLOBALS_RETIRED.data));
+    }
+    GLOBALS_RETIRED.data[GLOBALS_RETIRED.size++] = old;
+  }
+  variable->value = value;
+  pthread_mutex_unlock(&GLOBALS_MUTEX);
+}
+
+// nothing else reads the replaced values once the globals are not shared
+static void threadGlobalsRelease() {
+  if (threadGlobalsShared()) {
+    return;
+  }
+  threadGlobalsLock();
+  for (size_t i = 0; i < GLOBALS_RETIRED.size; ++i) {
+    astTreeDelete(GLOBALS_RETIRED.data[i]);
+  }
+  free(GLOBALS_RETIRED.data);
+  GLOBALS_RETIRED.data = NULL;
+  GLOBALS_RETIRED.size = 0;
+  pthread_mutex_unlock(&GLOBALS_MUTEX);
+}
+
+// runs the function with the arguments that it takes the ownership of
+static void threadCall(AstTreeFunction *function, AstTree **arguments,
+                       size_t arguments_size) {
+#ifdef RUNNER_TREE_WALKER
+  astTreeDelete(
+      runAstTreeFunction(function, arguments, arguments_size, false));
+#else
+  // an extra element so it is not zero-length
+  Value values[arguments_size + 1];
+  for (size_t i = 0; i < arguments_size; ++i) {
+    values[i] = valueFromTree(arguments[i]);
+  }
+  valueDelete(vmRunFunction(function, values, arguments_size));
+#endif
+}
+
+// releases what the thread made for itself before it exits
+static void threadExit() {
+#ifndef RUNNER_TREE_WALKER
+  // chunks point into the copies
+  vmDestroy();
+#endif
+  threadFunctionsDelete();
+  a404m_thread_exit();
+  __atomic_fetch_sub(&THREADS_RUNNING, 1, __ATOMIC_RELEASE);
+}
+
+static void *threadRun(void *data) {
+  ThreadStart *start = data;
+  AST_TREE_PRIVATE_COPIES = true;
+
+  threadCall(start->function->metadata, start->arguments,
+             start->arguments_size);
+
+  astTreeDelete(start->function);
+  free(start->arguments);
+  free(start);
+  threadExit();
+  return NULL;
+}
+
+AstTree *threadSpawn(AstTree **arguments, size_t arguments_size) {
+  AstTree *function = arguments[0];
+
+  ThreadStart *start = a404m_malloc(sizeof(*start));
+  start->arguments_size = arguments_size - 1;
+  start->arguments =
+      a404m_malloc(start->arguments_size * sizeof(*start->arguments));
+
+  // the thread owns what it is given, not the arena of the caller
+  const bool wasOpen = a404m_arena_pause();
+  start->function = newAstTree(
+      AST_TREE_TOKEN_FUNCTION,
+      copyAstTreeFunctionForThread(function->metadata),
+      copyAstTree(function->type), function->str_begin, function->str_end);
+  for (size_t i = 0; i < start->arguments_size; ++i) {
+    start->arguments[i] = copyAstTree(arguments[i + 1]);
+  }
+  a404m_arena_resume(wasOpen);
+
+  pthread_t thread;
+  outputShare();
+  __atomic_fetch_add(&THREADS_RUNNING, 1, __ATOMIC_RELAXED);
+  if (pthread_create(&thread, NULL, threadRun, start) != 0) {
+    printLog("Can't spawn a thread");
+    UNREACHABLE;
+  }
+
+  pthread_mutex_lock(&THREADS_MUTEX);
+  size_t capacity =
+      a404m_malloc_usable_size(THREADS.data) / sizeof(*THREADS.data);
+  if (capacity == THREADS.size) {
+    capacity += capacity / 2 + 1;
+    THREADS.data =
+        a404m_realloc(THREADS.data, capacity * sizeof(*THREADS.data));
+  }
+  THREADS.data[THREADS.size++] = (Thread){
+      .thread = thread,
+      .joined = false,
+  };
+  const AstTreeInt handle = THREADS.size;
+  pthread_mutex_unlock(&THREADS_MUTEX);
+
+  AstTreeInt *value = a404m_slab_malloc(sizeof(*value));
+  *value = handle;
+  return newAstTree(AST_TREE_TOKEN_VALUE_INT, value,
+                    copyAstTree(&AST_TREE_U64_TYPE), NULL, NULL);
+}
+
+void threadJoin(AstTree **arguments) {
+  const AstTreeInt handle = *(AstTreeInt *)arguments[0]->metadata;
+
+  pthread_mutex_lock(&THREADS_MUTEX);
+  if (handle == 0 || handle > THREADS.size) {
+    printLog("Bad thread handle %lu", handle);
+    UNREACHABLE;
+  }
+  Thread *thread = &THREADS.data[handle - 1];
+  if (thread->joined) {
+    printLog("Thread %lu is already joined", handle);
+    UNREACHABLE;
+  }
+  thread->joined = true;
+  const pthread_t pthread = thread->thread;
+  pthread_mutex_unlock(&THREADS_MUTEX);
+
+  pthread_join(pthread, NULL);
+  threadGlobalsRelease();
+}
+
+static bool threadWorkerNext(ThreadWorker *worker, size_t *chunk) {
+  pthread_mutex_lock(&worker->mutex);
+  if (worker->begin != worker->end) {
+    *chunk = worker->begin++;
+    pthread_mutex_unlock(&worker->mutex);
+    return true;
+  }
+  pthread_mutex_unlock(&worker->mutex);
+
+  // steals half of what the first worker with chunks has left, only one lock
+  // is held at a time so there is no order to keep
+  ThreadParallel *parallel = worker->parallel;
+  for (size_t i = 1; i < parallel->workers_size; ++i) {
+    ThreadWorker *victim =
+        &parallel->workers[(worker->index + i) % parallel->workers_size];
+    pthread_mutex_lock(&victim->mutex);
+    const size_t left = victim->end - victim->begin;
+    if (left == 0) {
+      pthread_mutex_unlock(&victim->mutex);
+      continue;
+    }
+    const size_t end = victim->end;
+    victim->end -= (left + 1) / 2;
+    const size_t begin = victim->end;
+    pthread_mutex_unlock(&victim->mutex);
+
+    pthread_mutex_lock(&worker->mutex);
+    worker->begin = begin + 1;
+    worker->end = end;
+    pthread_mutex_unlock(&worker->mutex);
+    *chunk = begin;
+    return true;
+  }
+  // chunks that are taken are run by who took them
+  return false;
+}
+
+static void *threadWorkerRun(void *data) {
+  ThreadWorker *worker = data;
+  ThreadParallel *parallel = worker->parallel;
+  AST_TREE_PRIVATE_COPIES = true;
+
+  const AstTreeInt size = parallel->end - parallel->begin;
+  const size_t arguments_size = parallel->arguments_size + 1;
+  AstTree **arguments = a404m_malloc(arguments_size * sizeof(*arguments));
+
+  size_t chunk;
+  while (threadWorkerNext(worker, &chunk)) {
+    const AstTreeInt begin =
+        parallel->begin + size * chunk / parallel->chunks_size;
+    const AstTreeInt end =
+        parallel->begin + size * (chunk + 1) / parallel->chunks_size;
+
+    outputCapture(&parallel->outputs[chunk]);
+    for (AstTreeInt i = begin; i < end; ++i) {
+      AstTreeInt *index = a404m_slab_malloc(sizeof(*index));
+      *index = i;
+      arguments[0] = newAstTree(AST_TREE_TOKEN_VALUE_INT, index,
+                                copyAstTree(&AST_TREE_I64_TYPE), NULL, NULL);
+      for (size_t j = 1; j < arguments_size; ++j) {
+        arguments[j] = copyAstTree(parallel->arguments[j - 1]);
+      }
+      threadCall(worker->function->metadata, arguments, arguments_size);
+    }
+    outputCapture(NULL);
+  }
+
+  free(arguments);
+  astTreeDelete(worker->function);
+  threadExit();
+  return NULL;
+}
+
+static size_t threadWorkersSize() {
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  return cpus < 1 ? 1 : cpus;
+}
+
+void threadParallelFor(AstTree **arguments, size_t arguments_size) {
+  const AstTreeInt begin = *(AstTreeInt *)arguments[0]->metadata;
+  const AstTreeInt end = *(AstTreeInt *)arguments[1]->metadata;
+  if ((i64)end <= (i64)begin) {
+    return;
+  }
+  AstTree *function = arguments[2];
+  const AstTreeInt size = end - begin;
+
+  ThreadParallel parallel = {
+      .begin = begin,
+      .end = end,
+      .arguments = arguments + 3,
+      .arguments_size = arguments_size - 3,
+      .workers_size = threadWorkersSize(),
+  };
+  parallel.chunks_size = parallel.workers_size * THREAD_CHUNKS_PER_WORKER;
+  if (parallel.chunks_size > size) {
+    parallel.chunks_size = size;
+  }
+  if (parallel.workers_size > parallel.chunks_size) {
+    parallel.workers_size = parallel.chunks_size;
+  }
+  parallel.outputs =
+      a404m_malloc(parallel.chunks_size * sizeof(*parallel.outputs));
+  for (size_t i = 0; i < parallel.chunks_size; ++i) {
+    parallel.outputs[i] = (OutputBuffer){
+        .data = NULL,
+        .size = 0,
+    };
+  }
+  parallel.workers =
+      a404m_malloc(parallel.workers_size * sizeof(*parallel.workers));
+
+  // the workers own what they are given, not the arena of the caller
+  const bool wasOpen = a404m_arena_pause();
+  for (size_t i = 0; i < parallel.workers_size; ++i) {
+    ThreadWorker *worker = &parallel.workers[i];
+    pthread_mutex_init(&worker->mutex, NULL);
+    worker->begin = parallel.chunks_size * i / parallel.workers_size;
+    worker->end = parallel.chunks_size * (i + 1) / parallel.workers_size;
+    worker->function = newAstTree(
+        AST_TREE_TOKEN_FUNCTION,
+        copyAstTreeFunctionForThread(function->metadata),
+        copyAstTree(function->type), function->str_begin, function->str_end);
+    worker->parallel = &parallel;
+    worker->index = i;
+  }
+  a404m_arena_resume(wasOpen);
+
+  __atomic_fetch_add(&THREADS_RUNNING, parallel.workers_size,
+                     __ATOMIC_RELAXED);
+  for (size_t i = 0; i < parallel.workers_size; ++i) {
+    ThreadWorker *worker = &parallel.workers[i];
+    if (pthread_create(&worker->thread, NULL, threadWorkerRun, worker) != 0) {
+      printLog("Can't spawn a thread");
+      UNREACHABLE;
+    }
+  }
+  for (size_t i = 0; i < parallel.workers_size; ++i) {
+    pthread_join(parallel.workers[i].thread, NULL);
+  }
+  // the others steal from a worker until they are done too
+  for (size_t i = 0; i < parallel.workers_size; ++i) {
+    pthread_mutex_destroy(&parallel.workers[i].mutex);
+  }
+  threadGlobalsRelease();
+
+  for (size_t i = 0; i < parallel.chunks_size; ++i) {
+    outputWrite(parallel.outputs[i].data, parallel.outputs[i].size);
+    free(parallel.outputs[i].data);
+  }
+  free(parallel.outputs);
+  free(parallel.workers);
+}
+
+// the low bytes of the storage are the value like the arithmetic of the
+// runner, so the same operation on unsigned of the size works for signed too
+#define THREAD_ATOMIC(ctype)                                                   \
+  do {                                                                         \
+    ctype *pointer = (ctype *)cell;                                            \
+    switch (token) {                                                           \
+    case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:                                   \
+      return __atomic_load_n(pointer, __ATOMIC_SEQ_CST);                       \
+    case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:                                  \
+      __atomic_store_n(pointer, value, __ATOMIC_SEQ_CST);                      \
+      return 0;                                                                \
+    case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD:                                    \
+      return __atomic_fetch_add(pointer, value, __ATOMIC_SEQ_CST);             \
+    case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE: {                     \
+      ctype expected = value;                                                  \
+      return __atomic_compare_exchange_n(pointer, &expected, desired, false,   \
+                                         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);  \
+    }                                                                          \
+    default:                                                                   \
+      UNREACHABLE;                                                             \
+    }                                                                          \
+  } while (0)
+
+static AstTreeInt threadAtomicInt(AstTreeToken token, AstTreeInt *cell,
+                                  size_t size, AstTreeInt value,
+                                  AstTreeInt desired) {
+  switch (size) {
+  case 1:
+    THREAD_ATOMIC(u8);
+  case 2:
+    THREAD_ATOMIC(u16);
+  case 4:
+    THREAD_ATOMIC(u32);
+  case 8:
+    THREAD_ATOMIC(u64);
+  }
+  UNREACHABLE;
+}
+
+#undef THREAD_ATOMIC
+
+AstTree *threadAtomic(AstTreeToken token, AstTree **arguments) {
+  if (arguments[0]->token != AST_TREE_TOKEN_VARIABLE) {
+    UNREACHABLE;
+  }
+  AstTreeVariable *variable = arguments[0]->metadata;
+  if (variable->value == NULL ||
+      variable->value->token != AST_TREE_TOKEN_VALUE_INT) {
+    printLog("Atomics need a variable with an integer value");
+    UNREACHABLE;
+  }
+
+  AstTreeInt *cell = variable->value->metadata;
+  const size_t size = getSizeOfType(variable->type);
+  const AstTreeInt value = token == AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD
+                               ? 0
+                               : *(AstTreeInt *)arguments[1]->metadata;
+  const AstTreeInt desired =
+      token == AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE
+          ? *(AstTreeInt *)arguments[2]->metadata
+          : 0;
+
+  const AstTreeInt result = threadAtomicInt(token, cell, size, value, desired);
+
+  switch (token) {
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_LOAD:
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_ADD: {
+    AstTreeInt *ret = a404m_slab_malloc(sizeof(*ret));
+    *ret = result;
+    return newAstTree(AST_TREE_TOKEN_VALUE_INT, ret,
+                      copyAstTree(variable->type), NULL, NULL);
+  }
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_STORE:
+    return &AST_TREE_VOID_VALUE;
+  case AST_TREE_TOKEN_BUILTIN_ATOMIC_COMPARE_EXCHANGE: {
+    AstTreeBool *ret = a404m_slab_malloc(sizeof(*ret));
+    *ret = result != 0;
+    return newAstTree(AST_TREE_TOKEN_VALUE_BOOL, ret,
+                      copyAstTree(&AST_TREE_BOOL_TYPE), NULL, NULL);
+  }
+  default:
+    UNREACHABLE;
+  }
+}
+
+void threadDestroy() {
+  // running threads can still spawn more
+  for (size_t i = 0;; ++i) {
+    pthread_mutex_lock(&THREADS_MUTEX);
+    if (i == THREADS.size) {
+      pthread_mutex_unlock(&THREADS_MUTEX);
+      break;
+    }
+    Thread *thread = &THREADS.data[i];
+    const bool joined = thread->joined;
+    thread->joined = true;
+    const pthread_t pthread = thread->thread;
+    pthread_mutex_unlock(&THREADS_MUTEX);
+    if (!joined) {
+      pthread_join(pthread, NULL);
+    }
+  }
+  free(THREADS.data);
+  THREADS.data = NULL;
+  THREADS.size = 0;
+  threadGlobalsRelease();
+}
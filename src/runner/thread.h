@@ -0,0 +1,38 @@
+#pragma once
+
+#include "compiler/ast-tree.h"
+
+// runs @spawn(function, ...) with its evaluated arguments on a new thread
+AstTree *threadSpawn(AstTree **arguments, size_t arguments_size);
+
+// runs @join(handle)
+void threadJoin(AstTree **arguments);
+
+// runs @parallelFor(begin, end, function, ...) on a pool of threads that steal
+// chunks of the range from each other, the output of the calls is written in
+// the order of the indices
+void threadParallelFor(AstTree **arguments, size_t arguments_size);
+
+// runs @atomicLoad, @atomicStore, @atomicAdd and @atomicCompareExchange
+AstTree *threadAtomic(AstTreeToken token, AstTree **arguments);
+
+// the function that the calling thread runs instead of a shared one, spawned
+// threads run private copies so they don't share the variables of the calls
+AstTreeFunction *threadFunction(AstTreeFunction *function);
+
+// copy of a shared function value for the calling thread
+AstTree *threadCopyFunction(AstTree *function);
+
+// globals are shared while a spawned thread or a worker is running, then
+// they are read and written under the lock of them
+bool threadGlobalsShared();
+void threadGlobalsLock();
+void threadGlobalsUnlock();
+
+// sets a shared global, ints, floats and bools are written in the value that
+// it has so atomics keep their cell, other values are replaced and the old one
+// is kept until the globals are not shared since another thread may read it
+void threadGlobalSet(AstTreeVariable *variable, AstTree *value);
+
+// joins the threads that are not joined yet
+void threadDestroy();
@@ -0,0 +1,645 @@
+#include "value.h"
+
+#include "runner/runner.h"
+#include "runner/thread.h"
+#include "utils/log.h"
+#include "utils/memory.h"
+#include <string.h>
+
+const char *VALUE_TAG_STRINGS[] = {
+    "VALUE_TAG_TREE", "VALUE_TAG_VOID", "VALUE_TAG_INT",  "VALUE_TAG_FLOAT",
+    "VALUE_TAG_BOOL", "VALUE_TAG_TYPE", "VALUE_TAG_REF",  "VALUE_TAG_RAW_REF",
+};
+
+const Value VALUE_VOID = {
+    .tag = VALUE_TAG_VOID,
+    .type = NULL,
+    .tree = NULL,
+};
+
+// scalars keep the exact bits of the metadata of their tree so they can be
+// boxed back without changing what the tree-walker kernels see
+static bool valueFromScalarTree(AstTree *tree, Value *value) {
+  if (tree == &AST_TREE_VOID_VALUE) {
+    *value = VALUE_VOID;
+    return true;
+  } else if (!astTreeShouldDelete(tree)) {
+    *value = (Value){
+        .tag = VALUE_TAG_TYPE,
+        .type = NULL,
+        .tree = tree,
+    };
+    return true;
+  }
+
+  switch (tree->token) {
+  case AST_TREE_TOKEN_VALUE_INT:
+    if (astTreeShouldDelete(tree->type)) {
+      return false;
+    }
+    *value = (Value){
+        .tag = VALUE_TAG_INT,
+        .type = tree->type,
+        .i = *(AstTreeInt *)tree->metadata,
+    };
+    return true;
+  case AST_TREE_TOKEN_VALUE_FLOAT:
+    if (astTreeShouldDelete(tree->type)) {
+      return false;
+    }
+    *value = (Value){
+        .tag = VALUE_TAG_FLOAT,
+        .type = tree->type,
+        .f = *(AstTreeFloat *)tree->metadata,
+    };
+    return true;
+  case AST_TREE_TOKEN_VALUE_BOOL:
+    if (astTreeShouldDelete(tree->type)) {
+      return false;
+    }
+    *value = (Value){
+        .tag = VALUE_TAG_BOOL,
+        .type = tree->type,
+        .b = *(AstTreeBool *)tree->metadata,
+    };
+    return true;
+  case AST_TREE_TOKEN_VARIABLE:
+    *value = valueFromVariable(tree->metadata);
+    return true;
+  case AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED:
+    // a view of one element is the place of it, arrays stay trees
+    if (isRawType(tree->type)) {
+      AstTreeRawValue *metadata = tree->metadata;
+      *value = (Value){
+          .tag = VALUE_TAG_RAW_REF,
+          .type = tree->type,
+          .raw = metadata->data,
+      };
+      return true;
+    }
+    return false;
+  default:
+    return false;
+  }
+}
+
+Value valueFromTree(AstTree *tree) {
+  Value value;
+  if (valueFromScalarTree(tree, &value)) {
+    astTreeDelete(tree);
+    return value;
+  }
+  return (Value){
+      .tag = VALUE_TAG_TREE,
+      .type = NULL,
+      .tree = tree,
+  };
+}
+
+Value valueCopyFromTree(AstTree *tree) {
+  Value value;
+  if (valueFromScalarTree(tree, &value)) {
+    return value;
+  }
+  return (Value){
+      .tag = VALUE_TAG_TREE,
+      .type = NULL,
+      .tree = copyAstTree(tree),
+  };
+}
+
+AstTree *valueToTree(Value value) {
+  switch (value.tag) {
+  case VALUE_TAG_TREE:
+  case VALUE_TAG_TYPE:
+    return value.tree;
+  case VALUE_TAG_VOID:
+    return &AST_TREE_VOID_VALUE;
+  case VALUE_TAG_INT: {
+    AstTreeInt *metadata = a404m_slab_malloc(sizeof(*metadata));
+    *metadata = value.i;
+    return newAstTree(AST_TREE_TOKEN_VALUE_INT, metadata, value.type, NULL,
+                      NULL);
+  }
+  case VALUE_TAG_FLOAT: {
+    AstTreeFloat *metadata = a404m_slab_malloc(sizeof(*metadata));
+    *metadata = value.f;
+    return newAstTree(AST_TREE_TOKEN_VALUE_FLOAT, metadata, value.type, NULL,
+                      NULL);
+  }
+  case VALUE_TAG_BOOL: {
+    AstTreeBool *metadata = a404m_slab_malloc(sizeof(*metadata));
+    *metadata = value.b;
+    return newAstTree(AST_TREE_TOKEN_VALUE_BOOL, metadata, value.type, NULL,
+                      NULL);
+  }
+  case VALUE_TAG_REF: {
+    AstTreeVariable *variable = value.variable;
+    return newAstTree(AST_TREE_TOKEN_VARIABLE, variable,
+                      copyAstTree(variable->type), variable->name_begin,
+                      variable->name_end);
+  }
+  case VALUE_TAG_RAW_REF: {
+    AstTreeRawValue *metadata = a404m_malloc(sizeof(*metadata));
+    metadata->data = value.raw;
+    metadata->size = getSizeOfType(value.type);
+    return newAstTree(AST_TREE_TOKEN_RAW_VALUE_NOT_OWNED, metadata, value.type,
+                      NULL, NULL);
+  }
+  }
+  UNREACHABLE;
+}
+
+Value valueFromVariable(AstTreeVariable *variable) {
+  return (Value){
+      .tag = VALUE_TAG_REF,
+      .type = NULL,
+      .variable = variable,
+  };
+}
+
+Value valueCopy(Value value) {
+  if (value.tag == VALUE_TAG_TREE) {
+    value.tree = copyAstTree(value.tree);
+  }
+  return value;
+}
+
+void valueDelete(Value value) {
+  if (value.tag == VALUE_TAG_TREE) {
+    astTreeDelete(value.tree);
+  }
+}
+
+void valueSetVariable(AstTreeVariable *variable, Value value) {
+  if (variable->isConst) {
+    printLog("Can't assign to const");
+    UNREACHABLE;
+  }
+
+  // shared globals are written under the lock of them
+  AstTree *old = variable->isGlobal && threadGlobalsShared()
+                     ? NULL
+                     : variable->value;
+  if (old != NULL && old != variable->initValue && old->type == value.type) {
+    switch (value.tag) {
+    case VALUE_TAG_INT:
+      if (old->token == AST_TREE_TOKEN_VALUE_INT) {
+        *(AstTreeInt *)old->metadata = value.i;
+        return;
+      }
+      break;
+    case VALUE_TAG_FLOAT:
+      if (old->token == AST_TREE_TOKEN_VALUE_FLOAT) {
+        *(AstTreeFloat *)old->metadata = value.f;
+        return;
+      }
+      break;
+    case VALUE_TAG_BOOL:
+      if (old->token == AST_TREE_TOKEN_VALUE_BOOL) {
+        *(AstTreeBool *)old->metadata = value.b;
+        return;
+      }
+      break;
+    case VALUE_TAG_TREE:
+    case VALUE_TAG_VOID:
+    case VALUE_TAG_TYPE:
+    case VALUE_TAG_REF:
+    case VALUE_TAG_RAW_REF:
+      break;
+    }
+  }
+  runnerVariableSetValueWihtoutConstCheck(variable, valueToTree(value));
+}
+
+// narrow ints are extended to the whole storage like the literals of them
+Value valueLoadRaw(AstTree *type, const u8 *data) {
+  Value value = {
+      .tag = VALUE_TAG_INT,
+      .type = type,
+      .i = 0,
+  };
+  switch (type->token) {
+  case AST_TREE_TOKEN_TYPE_I8:
+    value.i = *(i8 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_U8:
+    value.i = *(u8 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_I16:
+    value.i = *(i16 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_U16:
+    value.i = *(u16 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_I32:
+    value.i = *(i32 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_U32:
+    value.i = *(u32 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_I64:
+  case AST_TREE_TOKEN_TYPE_U64:
+    value.i = *(u64 *)data;
+    return value;
+#ifdef FLOAT_16_SUPPORT
+  case AST_TREE_TOKEN_TYPE_F16:
+    value.tag = VALUE_TAG_FLOAT;
+    value.f = *(f16 *)data;
+    return value;
+#endif
+  case AST_TREE_TOKEN_TYPE_F32:
+    value.tag = VALUE_TAG_FLOAT;
+    value.f = *(f32 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_F64:
+    value.tag = VALUE_TAG_FLOAT;
+    value.f = *(f64 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_F128:
+    value.tag = VALUE_TAG_FLOAT;
+    value.f = *(f128 *)data;
+    return value;
+  case AST_TREE_TOKEN_TYPE_BOOL:
+    value.tag = VALUE_TAG_BOOL;
+    value.b = *(AstTreeBool *)data;
+    return value;
+  default:
+  }
+  UNREACHABLE;
+}
+
+void valueStoreRaw(Value value, u8 *data) {
+  switch (value.tag) {
+  case VALUE_TAG_INT:
+    memcpy(data, &value.i, getSizeOfType(value.type));
+    return;
+  case VALUE_TAG_FLOAT:
+    // the elements are real floats of their type like the ones in c
+    switch (value.type->token) {
+#ifdef FLOAT_16_SUPPORT
+    case AST_TREE_TOKEN_TYPE_F16:
+      *(f16 *)data = value.f;
+      return;
+#endif
+    case AST_TREE_TOKEN_TYPE_F32:
+      *(f32 *)data = value.f;
+      return;
+    case AST_TREE_TOKEN_TYPE_F64:
+      *(f64 *)data = value.f;
+      return;
+    case AST_TREE_TOKEN_TYPE_F128:
+      *(f128 *)data = value.f;
+      return;
+    default:
+    }
+    break;
+  case VALUE_TAG_BOOL:
+    *(AstTreeBool *)data = value.b;
+    return;
+  case VALUE_TAG_TREE:
+  case VALUE_TAG_VOID:
+  case VALUE_TAG_TYPE:
+  case VALUE_TAG_REF:
+  case VALUE_TAG_RAW_REF:
+  }
+  UNREACHABLE;
+}
+
+// these mirror the kernels of runAstTreeBuiltin, narrow types only touch the
+// low bytes of the storage, they are copied out of it and back so the storage
+// is never read through a pointer of another type
+#define VALUE_UNARY(field, ctype, operator)                                    \
+  do {                                                                         \
+    ctype value;                                                               \
+    memcpy(&value, &result->field, sizeof(value));                             \
+    value = operator value;                                                    \
+    memcpy(&result->field, &value, sizeof(value));                             \
+  } while (0)
+
+#define VALUE_BINARY(field, ctype, operator)                                   \
+  do {                                                                         \
+    ctype left, right;                                                         \
+    memcpy(&left, &arguments[0].field, sizeof(left));                          \
+    memcpy(&right, &arguments[1].field, sizeof(right));                        \
+    left = left operator right;                                                \
+    memcpy(&result->field, &left, sizeof(left));                               \
+  } while (0)
+
+#define VALUE_COMPARE(field, ctype, operator)                                  \
+  do {                                                                         \
+    ctype left, right;                                                         \
+    memcpy(&left, &arguments[0].field, sizeof(left));                          \
+    memcpy(&right, &arguments[1].field, sizeof(right));                        \
+    result->b = left operator right;                                           \
+  } while (0)
+
+#define VALUE_INT_CASES(macro, operator)                                       \
+  case AST_TREE_TOKEN_TYPE_I8:                                                 \
+    macro(i, i8, operator);                                                    \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U8:                                                 \
+    macro(i, u8, operator);                                                    \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_I16:                                                \
+    macro(i, i16, operator);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U16:                                                \
+    macro(i, u16, operator);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_I32:                                                \
+    macro(i, i32, operator);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U32:                                                \
+    macro(i, u32, operator);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_I64:                                                \
+    macro(i, i64, operator);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U64:                                                \
+    macro(i, u64, operator);                                                   \
+    break;
+
+#ifdef FLOAT_16_SUPPORT
+#define VALUE_FLOAT_16_CASE(macro, operator)                                   \
+  case AST_TREE_TOKEN_TYPE_F16:                                                \
+    macro(f, f16, operator);                                                   \
+    break;
+#else
+#define VALUE_FLOAT_16_CASE(macro, operator)
+#endif
+
+#define VALUE_FLOAT_CASES(macro, operator)                                     \
+  VALUE_FLOAT_16_CASE(macro, operator)                                         \
+  case AST_TREE_TOKEN_TYPE_F32:                                                \
+    macro(f, f32, operator);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_F64:                                                \
+    macro(f, f64, operator);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_F128:                                               \
+    macro(f, f128, operator);                                                  \
+    break;
+
+static bool valueArithmetic(Value *arguments, Value *result,
+                            AstTreeToken token) {
+  *result = arguments[0];
+  switch (token) {
+  case AST_TREE_TOKEN_BUILTIN_ADD:
+    switch (result->type->token) {
+      VALUE_INT_CASES(VALUE_BINARY, +)
+      VALUE_FLOAT_CASES(VALUE_BINARY, +)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_SUB:
+    switch (result->type->token) {
+      VALUE_INT_CASES(VALUE_BINARY, -)
+      VALUE_FLOAT_CASES(VALUE_BINARY, -)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_MUL:
+    switch (result->type->token) {
+      VALUE_INT_CASES(VALUE_BINARY, *)
+      VALUE_FLOAT_CASES(VALUE_BINARY, *)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_DIV:
+    switch (result->type->token) {
+      VALUE_INT_CASES(VALUE_BINARY, /)
+      VALUE_FLOAT_CASES(VALUE_BINARY, /)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_MOD:
+    switch (result->type->token) {
+      VALUE_INT_CASES(VALUE_BINARY, %)
+    default:
+      return false;
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool valueCompare(Value *arguments, Value *result, AstTreeToken token) {
+  *result = (Value){
+      .tag = VALUE_TAG_BOOL,
+      .type = &AST_TREE_BOOL_TYPE,
+      .b = false,
+  };
+  switch (token) {
+  case AST_TREE_TOKEN_BUILTIN_EQUAL:
+    switch (arguments[0].type->token) {
+      VALUE_INT_CASES(VALUE_COMPARE, ==)
+      VALUE_FLOAT_CASES(VALUE_COMPARE, ==)
+    case AST_TREE_TOKEN_TYPE_BOOL:
+      VALUE_COMPARE(b, AstTreeBool, ==);
+      break;
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_NOT_EQUAL:
+    switch (arguments[0].type->token) {
+      VALUE_INT_CASES(VALUE_COMPARE, !=)
+      VALUE_FLOAT_CASES(VALUE_COMPARE, !=)
+    case AST_TREE_TOKEN_TYPE_BOOL:
+      VALUE_COMPARE(b, AstTreeBool, !=);
+      break;
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_GREATER:
+    switch (arguments[0].type->token) {
+      VALUE_INT_CASES(VALUE_COMPARE, >)
+      VALUE_FLOAT_CASES(VALUE_COMPARE, >)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_SMALLER:
+    switch (arguments[0].type->token) {
+      VALUE_INT_CASES(VALUE_COMPARE, <)
+      VALUE_FLOAT_CASES(VALUE_COMPARE, <)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
+    switch (arguments[0].type->token) {
+      VALUE_INT_CASES(VALUE_COMPARE, >=)
+      VALUE_FLOAT_CASES(VALUE_COMPARE, >=)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
+    switch (arguments[0].type->token) {
+      VALUE_INT_CASES(VALUE_COMPARE, <=)
+      VALUE_FLOAT_CASES(VALUE_COMPARE, <=)
+    default:
+      return false;
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+#define VALUE_CAST(value)                                                      \
+  switch (to->token) {                                                         \
+  case AST_TREE_TOKEN_TYPE_I8:                                                 \
+    result->i = (i8)(value);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U8:                                                 \
+    result->i = (u8)(value);                                                   \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_I16:                                                \
+    result->i = (i16)(value);                                                  \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U16:                                                \
+    result->i = (u16)(value);                                                  \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_I32:                                                \
+    result->i = (i32)(value);                                                  \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U32:                                                \
+    result->i = (u32)(value);                                                  \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_I64:                                                \
+    result->i = (i64)(value);                                                  \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_U64:                                                \
+    result->i = (u64)(value);                                                  \
+    break;                                                                     \
+    VALUE_CAST_FLOAT_16(value)                                                 \
+  case AST_TREE_TOKEN_TYPE_F32:                                                \
+    result->tag = VALUE_TAG_FLOAT;                                             \
+    result->f = (f32)(value);                                                  \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_F64:                                                \
+    result->tag = VALUE_TAG_FLOAT;                                             \
+    result->f = (f64)(value);                                                  \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_F128:                                               \
+    result->tag = VALUE_TAG_FLOAT;                                             \
+    result->f = (f128)(value);                                                 \
+    break;                                                                     \
+  case AST_TREE_TOKEN_TYPE_BOOL:                                               \
+    result->tag = VALUE_TAG_BOOL;                                              \
+    result->b = (bool)(value);                                                 \
+    break;                                                                     \
+  default:                                                                     \
+    return false;                                                              \
+  }
+
+#ifdef FLOAT_16_SUPPORT
+#define VALUE_CAST_FLOAT_16(value)                                             \
+  case AST_TREE_TOKEN_TYPE_F16:                                                \
+    result->tag = VALUE_TAG_FLOAT;                                             \
+    result->f = (f16)(value);                                                  \
+    break;
+#else
+#define VALUE_CAST_FLOAT_16(value)
+#endif
+
+static bool valueCast(Value from, AstTree *to, Value *result) {
+  *result = (Value){
+      .tag = VALUE_TAG_INT,
+      .type = to,
+      .i = 0,
+  };
+  switch (from.tag) {
+  case VALUE_TAG_INT:
+    VALUE_CAST(from.i);
+    return true;
+  case VALUE_TAG_FLOAT:
+    VALUE_CAST(from.f);
+    return true;
+  case VALUE_TAG_BOOL:
+    VALUE_CAST(from.b);
+    return true;
+  case VALUE_TAG_TREE:
+  case VALUE_TAG_VOID:
+  case VALUE_TAG_TYPE:
+  case VALUE_TAG_REF:
+  case VALUE_TAG_RAW_REF:
+    return false;
+  }
+  UNREACHABLE;
+}
+
+bool valueBuiltin(AstTreeToken token, Value *arguments, Value *result) {
+  switch (token) {
+  case AST_TREE_TOKEN_BUILTIN_CAST:
+    return arguments[1].tag == VALUE_TAG_TYPE &&
+           valueCast(arguments[0], arguments[1].tree, result);
+  case AST_TREE_TOKEN_BUILTIN_NEG:
+    *result = arguments[0];
+    switch (arguments[0].tag) {
+    case VALUE_TAG_INT:
+    case VALUE_TAG_FLOAT:
+      break;
+    case VALUE_TAG_TREE:
+    case VALUE_TAG_VOID:
+    case VALUE_TAG_BOOL:
+    case VALUE_TAG_TYPE:
+    case VALUE_TAG_REF:
+    case VALUE_TAG_RAW_REF:
+      return false;
+    }
+    switch (result->type->token) {
+      VALUE_INT_CASES(VALUE_UNARY, -)
+      VALUE_FLOAT_CASES(VALUE_UNARY, -)
+    default:
+      return false;
+    }
+    return true;
+  case AST_TREE_TOKEN_BUILTIN_ADD:
+  case AST_TREE_TOKEN_BUILTIN_SUB:
+  case AST_TREE_TOKEN_BUILTIN_MUL:
+  case AST_TREE_TOKEN_BUILTIN_DIV:
+  case AST_TREE_TOKEN_BUILTIN_MOD:
+    if ((arguments[0].tag != VALUE_TAG_INT &&
+         arguments[0].tag != VALUE_TAG_FLOAT) ||
+        arguments[1].tag != arguments[0].tag) {
+      return false;
+    }
+    return valueArithmetic(arguments, result, token);
+  case AST_TREE_TOKEN_BUILTIN_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_NOT_EQUAL:
+    if (arguments[0].tag == VALUE_TAG_TYPE &&
+        arguments[1].tag == VALUE_TAG_TYPE) {
+      const bool isEqual = typeIsEqual(arguments[0].tree, arguments[1].tree);
+      *result = (Value){
+          .tag = VALUE_TAG_BOOL,
+          .type = &AST_TREE_BOOL_TYPE,
+          .b = token == AST_TREE_TOKEN_BUILTIN_EQUAL ? isEqual : !isEqual,
+      };
+      return true;
+    }
+    // fall through
+  case AST_TREE_TOKEN_BUILTIN_GREATER:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER:
+  case AST_TREE_TOKEN_BUILTIN_GREATER_OR_EQUAL:
+  case AST_TREE_TOKEN_BUILTIN_SMALLER_OR_EQUAL:
+    if ((arguments[0].tag != VALUE_TAG_INT &&
+         arguments[0].tag != VALUE_TAG_FLOAT &&
+         arguments[0].tag != VALUE_TAG_BOOL) ||
+        arguments[1].tag != arguments[0].tag) {
+      return false;
+    }
+    return valueCompare(arguments, result, token);
+  default:
+    return false;
+  }
+}
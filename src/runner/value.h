@@ -0,0 +1,49 @@
+#pragma once
+
+#include "compiler/ast-tree.h"
+
+typedef enum ValueTag {
+  VALUE_TAG_TREE,
+  VALUE_TAG_VOID,
+  VALUE_TAG_INT,
+  VALUE_TAG_FLOAT,
+  VALUE_TAG_BOOL,
+  VALUE_TAG_TYPE,
+  VALUE_TAG_REF,
+  VALUE_TAG_RAW_REF,
+} ValueTag;
+
+extern const char *VALUE_TAG_STRINGS[];
+
+typedef struct Value {
+  ValueTag tag;
+  // static type of INT, FLOAT and BOOL values
+  AstTree *type;
+  union {
+    AstTreeInt i;
+    AstTreeFloat f;
+    AstTreeBool b;
+    // static type of TYPE values or owned tree of TREE values
+    AstTree *tree;
+    AstTreeVariable *variable;
+    // element of a RAW_VALUE, type is its static type
+    u8 *raw;
+  };
+} Value;
+
+extern const Value VALUE_VOID;
+
+Value valueFromTree(AstTree *tree);
+Value valueCopyFromTree(AstTree *tree);
+AstTree *valueToTree(Value value);
+Value valueFromVariable(AstTreeVariable *variable);
+
+Value valueCopy(Value value);
+void valueDelete(Value value);
+
+void valueSetVariable(AstTreeVariable *variable, Value value);
+
+Value valueLoadRaw(AstTree *type, const u8 *data);
+void valueStoreRaw(Value value, u8 *data);
+
+bool valueBuiltin(AstTreeToken token, Value *arguments, Value *result);
@@ -0,0 +1,459 @@
+#include "vm.h"
+
+#include "runner/runner.h"
+#include "runner/thread.h"
+#include "runner/value.h"
+#include "utils/log.h"
+#include "utils/memory.h"
+#include "utils/output.h"
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct VmChunkEntry {
+  AstTreeFunction *function;
+  BytecodeChunk *chunk;
+} VmChunkEntry;
+
+// each thread compiles the functions that it runs
+static _Thread_local struct {
+  VmChunkEntry *data;
+  size_t size;
+  size_t capacity;
+} VM_CHUNKS = {
+    .data = NULL,
+    .size = 0,
+    .capacity = 0,
+};
+
+static size_t vmChunkHash(AstTreeFunction *function) {
+  uintptr_t key = (uintptr_t)function;
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return key;
+}
+
+static void vmChunkInsert(AstTreeFunction *function, BytecodeChunk *chunk) {
+  if ((VM_CHUNKS.size + 1) * 2 > VM_CHUNKS.capacity) {
+    VmChunkEntry *old = VM_CHUNKS.data;
+    const size_t old_capacity = VM_CHUNKS.capacity;
+    VM_CHUNKS.capacity = old_capacity == 0 ? 64 : old_capacity * 2;
+    VM_CHUNKS.data =
+        a404m_malloc(VM_CHUNKS.capacity * sizeof(*VM_CHUNKS.data));
+    for (size_t i = 0; i < VM_CHUNKS.capacity; ++i) {
+      VM_CHUNKS.data[i].function = NULL;
+    }
+    VM_CHUNKS.size = 0;
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old[i].function != NULL) {
+        vmChunkInsert(old[i].function, old[i].chunk);
+      }
+    }
+    free(old);
+  }
+
+  const size_t mask = VM_CHUNKS.capacity - 1;
+  size_t i = vmChunkHash(function) & mask;
+  while (VM_CHUNKS.data[i].function != NULL) {
+    i = (i + 1) & mask;
+  }
+  VM_CHUNKS.data[i].function = function;
+  VM_CHUNKS.data[i].chunk = chunk;
+  VM_CHUNKS.size += 1;
+}
+
+BytecodeChunk *vmGetChunk(AstTreeFunction *function) {
+  if (VM_CHUNKS.capacity != 0) {
+    const size_t mask = VM_CHUNKS.capacity - 1;
+    for (size_t i = vmChunkHash(function) & mask;
+         VM_CHUNKS.data[i].function != NULL; i = (i + 1) & mask) {
+      if (VM_CHUNKS.data[i].function == function) {
+        return VM_CHUNKS.data[i].chunk;
+      }
+    }
+  }
+
+  BytecodeChunk *chunk = bytecodeCompileFunction(function);
+  if (chunk == NULL) {
+    printLog("Can't lower function to bytecode");
+    UNREACHABLE;
+  }
+  vmChunkInsert(function, chunk);
+  return chunk;
+}
+
+void vmDestroy() {
+  for (size_t i = 0; i < VM_CHUNKS.capacity; ++i) {
+    if (VM_CHUNKS.data[i].function != NULL) {
+      bytecodeChunkDelete(VM_CHUNKS.data[i].chunk);
+    }
+  }
+  free(VM_CHUNKS.data);
+  VM_CHUNKS.data = NULL;
+  VM_CHUNKS.size = 0;
+  VM_CHUNKS.capacity = 0;
+}
+
+static Value vmEval(AstTree *expr, bool isLeft) {
+  bool shouldRet = false;
+  u32 breakCount = 0;
+  bool shouldContinue = false;
+  AstTree *ret = runExpression(expr, NULL, &shouldRet, isLeft, false,
+                               &breakCount, &shouldContinue);
+  if (discontinue(shouldRet, breakCount)) {
+    UNREACHABLE;
+  }
+  return valueFromTree(ret);
+}
+
+static AstTreeVariable *vmPopRef(Value ref) {
+  if (ref.tag != VALUE_TAG_REF) {
+    printLog("%s", VALUE_TAG_STRINGS[ref.tag]);
+    UNREACHABLE;
+  }
+  return ref.variable;
+}
+
+static Value vmLoad(AstTreeVariable *variable) {
+  if (!variable->isConst && variable->isGlobal && threadGlobalsShared()) {
+    return valueFromTree(runnerVariableGetValue(variable));
+  } else if (variable->value == NULL) {
+    UNREACHABLE;
+  } else if (variable->isConst &&
+             variable->value->token == AST_TREE_TOKEN_FUNCTION) {
+    return valueFromTree(threadCopyFunction(variable->value));
+  }
+  return valueCopyFromTree(variable->value);
+}
+
+// the value of a view is replaced when it is materialized or copied before a
+// write, the frame slot has to follow it
+static void vmViewSync(Value *frame, AstTreeVariable *views, size_t views_size,
+                       AstTreeVariable *variable) {
+  if (variable >= views && variable < views + views_size) {
+    frame[variable - views].tree = variable->value;
+  }
+}
+
+Value vmRunFunction(AstTreeFunction *function, Value *arguments,
+                    size_t arguments_size) {
+  function = threadFunction(function);
+  const BytecodeChunk *chunk = vmGetChunk(function);
+  AstTreeVariable **boxed = chunk->boxed.data;
+  const size_t boxed_size = chunk->boxed.size;
+
+  // every array has an extra element so none of them is zero-length
+  Value frame[chunk->locals.size + 1];
+  for (size_t i = 0; i < arguments_size; ++i) {
+    frame[i] = arguments[i];
+  }
+  for (size_t i = arguments_size; i < chunk->locals.size; ++i) {
+    frame[i] = VALUE_VOID;
+  }
+
+  // boxed locals live in their variables, so save the outer activation for
+  // recursive calls and restore it on return
+  AstTree *saved[boxed_size + 1];
+  for (size_t i = 0; i < boxed_size; ++i) {
+    AstTreeVariable *variable = boxed[i];
+    saved[i] = variable->value;
+    if (variable->slot < arguments_size) {
+      variable->value = valueToTree(frame[variable->slot]);
+      frame[variable->slot] = VALUE_VOID;
+    } else {
+      variable->value = NULL;
+    }
+  }
+
+  // the tree-walker must not share the function while it has a frame here
+  function->running += 1;
+  const FrameMark frameMark = a404m_frame_mark();
+  // temporaries of leaf calls are freed at once when they return
+  if (function->isLeaf) {
+    a404m_arena_open();
+  }
+
+  Value stack[chunk->stack_size + 1];
+  size_t stack_size = 0;
+
+  // variables that stand for frame slots while their members or elements are
+  // reached, so only the locals that escape to the tree-walker are boxed
+  const size_t views_size = chunk->viewed ? chunk->locals.size : 0;
+  AstTreeVariable views[views_size + 1];
+
+  Value ret;
+  const BytecodeInstruction *instructions = chunk->instructions;
+  const BytecodeInstruction *ip = instructions;
+
+  for (;;) {
+    const BytecodeInstruction *instruction = ip++;
+    switch (instruction->opcode) {
+    case BYTECODE_OPCODE_PUSH:
+      stack[stack_size++] = valueCopyFromTree(instruction->tree);
+      continue;
+    case BYTECODE_OPCODE_PUSH_LAZY:
+      // lazy arguments are code, they must not be read as values
+      stack[stack_size++] = (Value){
+          .tag = VALUE_TAG_TREE,
+          .type = NULL,
+          .tree = runnerThunk(instruction->tree, instruction->operand),
+      };
+      continue;
+    case BYTECODE_OPCODE_POP:
+      for (u32 i = 0; i < instruction->operand; ++i) {
+        valueDelete(stack[--stack_size]);
+      }
+      continue;
+    case BYTECODE_OPCODE_LOAD_LOCAL:
+      stack[stack_size++] = valueCopy(frame[instruction->operand]);
+      continue;
+    case BYTECODE_OPCODE_LOAD_VARIABLE:
+      stack[stack_size++] = vmLoad(instruction->variable);
+      continue;
+    case BYTECODE_OPCODE_LOAD_LAZY: {
+      AstTreeVariable *variable = instruction->variable;
+      if (variable->value == NULL) {
+        UNREACHABLE;
+      }
+      stack[stack_size++] = vmEval(variable->value, false);
+      continue;
+    }
+    case BYTECODE_OPCODE_LOAD_LOCAL_REF: {
+      const Value *slot = &frame[instruction->operand];
+      if (slot->tag != VALUE_TAG_TREE) {
+        printLog("%s", VALUE_TAG_STRINGS[slot->tag]);
+        UNREACHABLE;
+      }
+      AstTreeVariable *view = &views[instruction->operand];
+      *view = *chunk->locals.data[instruction->operand];
+      view->value = slot->tree;
+      stack[stack_size++] = valueFromVariable(view);
+      continue;
+    }
+    case BYTECODE_OPCODE_STORE_LOCAL: {
+      Value *slot = &frame[instruction->operand];
+      valueDelete(*slot);
+      *slot = stack[stack_size - 1];
+      stack[stack_size - 1] = valueCopy(*slot);
+      continue;
+    }
+    case BYTECODE_OPCODE_STORE_VARIABLE: {
+      AstTreeVariable *variable = instruction->variable;
+      valueSetVariable(variable, stack[stack_size - 1]);
+      stack[stack_size - 1] = vmLoad(variable);
+      continue;
+    }
+    case BYTECODE_OPCODE_STORE: {
+      Value value = stack[--stack_size];
+      if (stack[stack_size - 1].tag == VALUE_TAG_RAW_REF) {
+        valueStoreRaw(value, stack[stack_size - 1].raw);
+        stack[stack_size - 1] = value;
+        continue;
+      }
+      AstTreeVariable *variable = vmPopRef(stack[stack_size - 1]);
+      valueSetVariable(variable, value);
+      stack[stack_size - 1] = vmLoad(variable);
+      continue;
+    }
+    case BYTECODE_OPCODE_DEFINE: {
+      Value *slot = &frame[instruction->operand];
+      valueDelete(*slot);
+      *slot = stack[stack_size - 1];
+      stack[stack_size - 1] = VALUE_VOID;
+      continue;
+    }
+    case BYTECODE_OPCODE_DEFINE_VARIABLE:
+      valueSetVariable(instruction->variable, stack[stack_size - 1]);
+      stack[stack_size - 1] = VALUE_VOID;
+      continue;
+    case BYTECODE_OPCODE_DEFINE_LAZY: {
+      AstTreeVariable *variable = instruction->variable;
+      runnerVariableSetValue(
+          variable, runnerThunk(variable->initValue, variable->isByName));
+      stack[stack_size++] = VALUE_VOID;
+      continue;
+    }
+    case BYTECODE_OPCODE_DEREFERENCE:
+      stack[stack_size - 1] = vmLoad(vmPopRef(stack[stack_size - 1]));
+      continue;
+    case BYTECODE_OPCODE_ACCESS: {
+      AstTreeVariable *variable = vmPopRef(stack[stack_size - 1]);
+      if (variable->type->token == AST_TREE_TOKEN_KEYWORD_STRUCT) {
+        AstTree *type;
+        u8 *raw =
+            runnerStructRawMember(variable, instruction->operand, &type, false);
+        if (raw != NULL) {
+          stack[stack_size - 1] = valueLoadRaw(type, raw);
+        } else {
+          stack[stack_size - 1] =
+              vmLoad(runnerStructMember(variable, instruction->operand));
+        }
+      } else {
+        stack[stack_size - 1] = valueFromTree(
+            runnerAccessMember(variable, instruction->operand, false));
+      }
+      vmViewSync(frame, views, views_size, variable);
+      continue;
+    }
+    case BYTECODE_OPCODE_ACCESS_REF: {
+      AstTreeVariable *variable = vmPopRef(stack[stack_size - 1]);
+      if (variable->type->token != AST_TREE_TOKEN_KEYWORD_STRUCT) {
+        UNREACHABLE;
+      }
+      AstTree *type;
+      u8 *raw =
+          runnerStructRawMember(variable, instruction->operand, &type, true);
+      if (raw != NULL) {
+        stack[stack_size - 1] = (Value){
+            .tag = VALUE_TAG_RAW_REF,
+            .type = type,
+            .raw = raw,
+        };
+      } else {
+        stack[stack_size - 1] = valueFromVariable(
+            runnerStructMember(variable, instruction->operand));
+      }
+      vmViewSync(frame, views, views_size, variable);
+      continue;
+    }
+    case BYTECODE_OPCODE_INDEX:
+    case BYTECODE_OPCODE_INDEX_REF: {
+      const Value index = stack[--stack_size];
+      if (index.tag != VALUE_TAG_INT) {
+        UNREACHABLE;
+      }
+      AstTreeVariable *array = vmPopRef(stack[stack_size - 1]);
+      AstTree *type;
+      const bool isRef = instruction->opcode == BYTECODE_OPCODE_INDEX_REF;
+      u8 *raw = runnerArrayRawElement(array, index.i, &type, isRef);
+      vmViewSync(frame, views, views_size, array);
+      if (raw != NULL) {
+        if (isRef) {
+          stack[stack_size - 1] = (Value){
+              .tag = VALUE_TAG_RAW_REF,
+              .type = type,
+              .raw = raw,
+          };
+        } else {
+          stack[stack_size - 1] = valueLoadRaw(type, raw);
+        }
+        continue;
+      }
+      AstTreeVariable *element = runnerArrayElement(array, index.i);
+      vmViewSync(frame, views, views_size, array);
+      if (isRef) {
+        stack[stack_size - 1] = valueFromVariable(element);
+      } else {
+        stack[stack_size - 1] = vmLoad(element);
+      }
+      continue;
+    }
+    case BYTECODE_OPCODE_JUMP:
+      ip = instructions + instruction->operand;
+      continue;
+    case BYTECODE_OPCODE_JUMP_IF_FALSE: {
+      const Value condition = stack[--stack_size];
+      if (condition.tag != VALUE_TAG_BOOL) {
+        UNREACHABLE;
+      }
+      if (!condition.b) {
+        ip = instructions + instruction->operand;
+      }
+      continue;
+    }
+    case BYTECODE_OPCODE_JUMP_IF_FALSE_OR_POP:
+    case BYTECODE_OPCODE_JUMP_IF_TRUE_OR_POP: {
+      const Value condition = stack[stack_size - 1];
+      if (condition.tag != VALUE_TAG_BOOL) {
+        UNREACHABLE;
+      }
+      if (condition.b ==
+          (instruction->opcode == BYTECODE_OPCODE_JUMP_IF_TRUE_OR_POP)) {
+        ip = instructions + instruction->operand;
+      } else {
+        stack_size -= 1;
+      }
+      continue;
+    }
+    case BYTECODE_OPCODE_CALL: {
+      stack_size -= instruction->operand;
+      stack[stack_size] = vmRunFunction(
+          instruction->function, stack + stack_size, instruction->operand);
+      stack_size += 1;
+      continue;
+    }
+    case BYTECODE_OPCODE_BUILTIN: {
+      stack_size -= instruction->operand;
+      Value *values = stack + stack_size;
+      Value result;
+      if (!valueBuiltin(instruction->builtin, values, &result)) {
+        AstTree *args[instruction->operand + 1];
+        for (u32 i = 0; i < instruction->operand; ++i) {
+          args[i] = valueToTree(values[i]);
+        }
+        result = valueFromTree(
+            runAstTreeBuiltin(instruction->builtin, NULL, args,
+                              instruction->operand));
+        for (u32 i = 0; i < instruction->operand; ++i) {
+          if (values[i].tag == VALUE_TAG_REF) {
+            // the builtin wrote the variable of the argument
+            vmViewSync(frame, views, views_size, values[i].variable);
+          }
+          astTreeDelete(args[i]);
+        }
+      } else {
+        for (u32 i = 0; i < instruction->operand; ++i) {
+          valueDelete(values[i]);
+        }
+      }
+      stack[stack_size++] = result;
+      continue;
+    }
+    case BYTECODE_OPCODE_PUTC: {
+      const Value value = stack[stack_size - 1];
+      if (value.tag != VALUE_TAG_INT) {
+        UNREACHABLE;
+      }
+      outputPutc((u8)value.i);
+      stack[stack_size - 1] = VALUE_VOID;
+      continue;
+    }
+    case BYTECODE_OPCODE_RETURN:
+      ret = stack[--stack_size];
+      goto RETURN;
+    case BYTECODE_OPCODE_EVAL:
+      stack[stack_size++] = vmEval(instruction->tree, false);
+      continue;
+    case BYTECODE_OPCODE_EVAL_REF:
+      stack[stack_size++] = vmEval(instruction->tree, true);
+      continue;
+    }
+    UNREACHABLE;
+  }
+
+RETURN:
+  while (stack_size != 0) {
+    valueDelete(stack[--stack_size]);
+  }
+  for (size_t i = 0; i < chunk->locals.size; ++i) {
+    valueDelete(frame[i]);
+  }
+  for (size_t i = 0; i < boxed_size; ++i) {
+    if (boxed[i]->value != NULL) {
+      astTreeDelete(boxed[i]->value);
+    }
+    boxed[i]->value = saved[i];
+  }
+  if (function->isLeaf) {
+    if (ret.tag == VALUE_TAG_TREE) {
+      ret.tree = runnerArenaEscape(ret.tree);
+    }
+    a404m_arena_close();
+  }
+  if (ret.tag == VALUE_TAG_TREE) {
+    runnerCheckFrameEscape(ret.tree, frameMark);
+  }
+  a404m_frame_release(frameMark);
+  function->running -= 1;
+  return ret;
+}
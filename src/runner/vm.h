@@ -0,0 +1,11 @@
+#pragma once
+
+#include "compiler/ast-tree.h"
+#include "runner/bytecode.h"
+#include "runner/value.h"
+
+BytecodeChunk *vmGetChunk(AstTreeFunction *function);
+void vmDestroy();
+
+Value vmRunFunction(AstTreeFunction *function, Value *arguments,
+                    size_t arguments_size);
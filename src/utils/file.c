@@ -3,13 +3,36 @@
 #include "utils/log.h"
 #include "utils/memory.h"
 #include "utils/string.h"
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 size_t fileCodes_capacity = 0;
 char **fileCodes = NULL;
 char **fileCodes_names = NULL;
 size_t fileCodes_length = 0;
 
+typedef struct FileMapping {
+  u8 *data;
+  size_t size;
+} FileMapping;
+
+static struct {
+  FileMapping *data;
+  size_t size;
+} FILE_MAPPINGS = {
+    .data = NULL,
+    .size = 0,
+};
+// threads of @spawn share the mappings
+static pthread_mutex_t FILE_MAPPINGS_MUTEX = PTHREAD_MUTEX_INITIALIZER;
+// count of the mappings, it is read without the lock so writes to memory
+// don't take it while nothing is mapped
+static size_t FILE_MAPPINGS_LIVE = 0;
+
 void fileInit() {
   fileCodes_capacity = 0;
   fileCodes = a404m_malloc(fileCodes_capacity * sizeof(*fileCodes));
@@ -26,6 +49,14 @@ void fileDelete() {
   free(fileCodes);
   free(fileCodes_names);
   fileCodes_length = 0;
+
+  for (size_t i = 0; i < FILE_MAPPINGS.size; ++i) {
+    munmap(FILE_MAPPINGS.data[i].data, FILE_MAPPINGS.data[i].size);
+  }
+  free(FILE_MAPPINGS.data);
+  FILE_MAPPINGS.data = NULL;
+  FILE_MAPPINGS.size = 0;
+  FILE_MAPPINGS_LIVE = 0;
 }
 
 void filePush(const char *filePath, char *code) {
@@ -131,3 +162,81 @@ char *joinToPathOf(const char *original, const char *file) {
 
   return result;
 }
+
+bool fileMap(const char *filePath, u8 **data, size_t *size) {
+  const int fd = open(filePath, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  *size = st.st_size;
+  if (*size == 0) {
+    close(fd);
+    *data = NULL;
+    return true;
+  }
+  void *mapped = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  *data = mapped;
+
+  pthread_mutex_lock(&FILE_MAPPINGS_MUTEX);
+  size_t capacity = a404m_malloc_usable_size(FILE_MAPPINGS.data) /
+                    sizeof(*FILE_MAPPINGS.data);
+  if (capacity == FILE_MAPPINGS.size) {
+    capacity += capacity / 2 + 1;
+    FILE_MAPPINGS.data = a404m_realloc(FILE_MAPPINGS.data,
+                                       capacity * sizeof(*FILE_MAPPINGS.data));
+  }
+  FILE_MAPPINGS.data[FILE_MAPPINGS.size++] = (FileMapping){
+      .data = *data,
+      .size = *size,
+  };
+  __atomic_store_n(&FILE_MAPPINGS_LIVE, FILE_MAPPINGS.size, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&FILE_MAPPINGS_MUTEX);
+  return true;
+}
+
+bool fileUnmap(u8 *data) {
+  if (data == NULL) {
+    return true;
+  }
+  pthread_mutex_lock(&FILE_MAPPINGS_MUTEX);
+  for (size_t i = 0; i < FILE_MAPPINGS.size; ++i) {
+    FileMapping mapping = FILE_MAPPINGS.data[i];
+    if (mapping.data == data) {
+      FILE_MAPPINGS.data[i] = FILE_MAPPINGS.data[--FILE_MAPPINGS.size];
+      __atomic_store_n(&FILE_MAPPINGS_LIVE, FILE_MAPPINGS.size,
+                       __ATOMIC_RELAXED);
+      pthread_mutex_unlock(&FILE_MAPPINGS_MUTEX);
+      munmap(mapping.data, mapping.size);
+      return true;
+    }
+  }
+  pthread_mutex_unlock(&FILE_MAPPINGS_MUTEX);
+  return false;
+}
+
+bool fileIsMapped(const u8 *data) {
+  if (data == NULL ||
+      __atomic_load_n(&FILE_MAPPINGS_LIVE, __ATOMIC_RELAXED) == 0) {
+    return false;
+  }
+  pthread_mutex_lock(&FILE_MAPPINGS_MUTEX);
+  for (size_t i = 0; i < FILE_MAPPINGS.size; ++i) {
+    FileMapping mapping = FILE_MAPPINGS.data[i];
+    if (data >= mapping.data && data < mapping.data + mapping.size) {
+      pthread_mutex_unlock(&FILE_MAPPINGS_MUTEX);
+      return true;
+    }
+  }
+  pthread_mutex_unlock(&FILE_MAPPINGS_MUTEX);
+  return false;
+}
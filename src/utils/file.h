@@ -1,5 +1,6 @@
 #pragma once
 
+#include "utils/type.h"
 #include <stddef.h>
 
 extern size_t fileCodes_capacity;
@@ -16,3 +17,10 @@ char *readWholeFile(const char *filePath);
 size_t getFileIndex(const char *filePath);
 
 char *joinToPathOf(const char *original, const char *file);
+
+// maps the file read only, empty files are mapped to NULL
+bool fileMap(const char *filePath, u8 **data, size_t *size);
+// false if the data is not what fileMap has given
+bool fileUnmap(u8 *data);
+// true if the data is in what fileMap has given, it can't be written
+bool fileIsMapped(const u8 *data);
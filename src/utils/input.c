@@ -0,0 +1,84 @@
+#include "input.h"
+
+#include "utils/memory.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// what is not read yet is input[input_begin, input_end)
+static u8 *input = NULL;
+static size_t input_begin = 0;
+static size_t input_end = 0;
+static size_t input_capacity = 0;
+// threads of @spawn share the buffer
+static pthread_mutex_t input_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t inputReadFd(u8 *data, size_t size) {
+  for (;;) {
+    const ssize_t res = read(STDIN_FILENO, data, size);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return 0;
+    }
+    return res;
+  }
+}
+
+static void inputFill() {
+  input_begin = 0;
+  input_end = inputReadFd(input, input_capacity);
+}
+
+void inputInit(size_t size) {
+  input_capacity = size == 0 ? 1 : size;
+  input = a404m_malloc(input_capacity * sizeof(*input));
+  input_begin = 0;
+  input_end = 0;
+}
+
+void inputDelete() {
+  free(input);
+  input = NULL;
+  input_capacity = 0;
+}
+
+i32 inputGetc() {
+  pthread_mutex_lock(&input_mutex);
+  if (input_begin == input_end) {
+    inputFill();
+  }
+  i32 c = -1;
+  if (input_begin != input_end) {
+    c = input[input_begin++];
+  }
+  pthread_mutex_unlock(&input_mutex);
+  return c;
+}
+
+size_t inputRead(u8 *data, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  pthread_mutex_lock(&input_mutex);
+  size_t res;
+  if (input_begin == input_end && size >= input_capacity) {
+    // no need to copy through the buffer for big reads
+    res = inputReadFd(data, size);
+  } else {
+    if (input_begin == input_end) {
+      inputFill();
+    }
+    res = input_end - input_begin;
+    if (res > size) {
+      res = size;
+    }
+    memcpy(data, input + input_begin, res);
+    input_begin += res;
+  }
+  pthread_mutex_unlock(&input_mutex);
+  return res;
+}
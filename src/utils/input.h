@@ -0,0 +1,14 @@
+#pragma once
+
+#include "utils/type.h"
+#include <stddef.h>
+
+#define INPUT_DEFAULT_SIZE (1024 * 1024)
+
+void inputInit(size_t size);
+void inputDelete();
+
+// next byte of stdin or -1 at the end of it
+i32 inputGetc();
+// reads at most size bytes, it returns 0 only at the end of stdin
+size_t inputRead(u8 *data, size_t size);
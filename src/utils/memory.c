@@ -1,6 +1,11 @@
 #include "memory.h"
 
+#include "utils/log.h"
+#include "utils/type.h"
 #include <malloc.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
 
 void *a404m_malloc(size_t size) {
   if (size == 0) {
@@ -28,3 +33,506 @@ size_t a404m_malloc_usable_size(void *pointer) {
     return malloc_usable_size(pointer);
   }
 }
+
+#ifdef SLAB_ALLOCATOR
+
+#define SLAB_GRANULE 8
+#define SLAB_CLASSES 16 // objects up to 128 bytes
+#define SLAB_CHUNK_SIZE (16 * 1024)
+
+typedef struct SlabFree {
+  struct SlabFree *next;
+} SlabFree;
+
+typedef struct SlabChunk {
+  struct SlabChunk *next;
+  max_align_t data[];
+} SlabChunk;
+
+static _Thread_local SlabFree *SLAB_FREE_LISTS[SLAB_CLASSES];
+static _Thread_local SlabChunk *SLAB_CHUNKS = NULL;
+static _Thread_local SlabStatistics SLAB_STATISTICS = {0};
+
+// chunks of threads that exited
+static SlabChunk *SLAB_ORPHAN_CHUNKS = NULL;
+static pthread_mutex_t SLAB_ORPHAN_MUTEX = PTHREAD_MUTEX_INITIALIZER;
+
+static void slabRefill(size_t class) {
+  const size_t objectSize = (class + 1) * SLAB_GRANULE;
+  SlabChunk *chunk = malloc(SLAB_CHUNK_SIZE);
+  chunk->next = SLAB_CHUNKS;
+  SLAB_CHUNKS = chunk;
+  SLAB_STATISTICS.chunks += 1;
+
+  u8 *begin = (u8 *)chunk->data;
+  const size_t count =
+      (SLAB_CHUNK_SIZE - (begin - (u8 *)chunk)) / objectSize;
+
+  SlabFree *head = SLAB_FREE_LISTS[class];
+  for (size_t i = count; i-- > 0;) {
+    SlabFree *object = (SlabFree *)(begin + i * objectSize);
+    object->next = head;
+    head = object;
+  }
+  SLAB_FREE_LISTS[class] = head;
+}
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGN 16
+
+typedef struct ArenaChunk {
+  struct ArenaChunk *next;
+  size_t used;
+  max_align_t data[];
+} ArenaChunk;
+
+// owner of an arena block, each opening of the arena is a new generation
+typedef union ArenaTag {
+  size_t generation;
+  u8 align[ARENA_ALIGN];
+} ArenaTag;
+
+#define ARENA_CHUNK_DATA_SIZE (ARENA_CHUNK_SIZE - sizeof(ArenaChunk))
+
+// chunks in use are from ARENA_FIRST to ARENA_CURRENT, the rest are kept for
+// the next use
+static _Thread_local ArenaChunk *ARENA_FIRST = NULL;
+static _Thread_local ArenaChunk *ARENA_CURRENT = NULL;
+static _Thread_local size_t ARENA_DEPTH = 0;
+static _Thread_local size_t ARENA_GENERATION = 0;
+static _Thread_local bool ARENA_OPEN = false;
+
+static void *arenaMalloc(size_t size) {
+  size = sizeof(ArenaTag) +
+         ((size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+  if (ARENA_CURRENT == NULL) {
+    if (ARENA_FIRST == NULL) {
+      ARENA_FIRST = malloc(ARENA_CHUNK_SIZE);
+      ARENA_FIRST->next = NULL;
+    }
+    ARENA_CURRENT = ARENA_FIRST;
+    ARENA_CURRENT->used = 0;
+  }
+  if (ARENA_CURRENT->used + size > ARENA_CHUNK_DATA_SIZE) {
+    if (ARENA_CURRENT->next == NULL) {
+      ArenaChunk *chunk = malloc(ARENA_CHUNK_SIZE);
+      chunk->next = NULL;
+      ARENA_CURRENT->next = chunk;
+    }
+    ARENA_CURRENT = ARENA_CURRENT->next;
+    ARENA_CURRENT->used = 0;
+  }
+  ArenaTag *tag = (ArenaTag *)((u8 *)ARENA_CURRENT->data + ARENA_CURRENT->used);
+  tag->generation = ARENA_GENERATION;
+  ARENA_CURRENT->used += size;
+  SLAB_STATISTICS.arenaAllocs += 1;
+  return tag + 1;
+}
+
+// the tag of the block if the pointer is in a chunk of the arena of the
+// calling thread, whether the arena is open or not
+static const ArenaTag *arenaTag(void *pointer) {
+  for (ArenaChunk *chunk = ARENA_FIRST; chunk != NULL; chunk = chunk->next) {
+    if ((u8 *)pointer >= (u8 *)chunk->data &&
+        (u8 *)pointer < (u8 *)chunk + ARENA_CHUNK_SIZE) {
+      return (ArenaTag *)pointer - 1;
+    }
+  }
+  return NULL;
+}
+
+void a404m_arena_open() {
+  if (ARENA_DEPTH == 0) {
+    ARENA_GENERATION += 1;
+  }
+  ARENA_DEPTH += 1;
+  ARENA_OPEN = true;
+}
+
+void a404m_arena_close() {
+  ARENA_DEPTH -= 1;
+  if (ARENA_DEPTH == 0) {
+    ARENA_OPEN = false;
+    ARENA_CURRENT = NULL;
+    SLAB_STATISTICS.arenaResets += 1;
+  }
+}
+
+bool a404m_arena_owns(void *pointer) {
+  const ArenaTag *tag = arenaTag(pointer);
+  return tag != NULL && ARENA_DEPTH != 0 && tag->generation == ARENA_GENERATION;
+}
+
+bool a404m_arena_pause() {
+  const bool wasOpen = ARENA_OPEN;
+  ARENA_OPEN = false;
+  return wasOpen;
+}
+
+void a404m_arena_resume(bool wasOpen) { ARENA_OPEN = wasOpen; }
+
+void *a404m_slab_malloc(size_t size) {
+  if (ARENA_OPEN && size != 0 && size <= SLAB_GRANULE * SLAB_CLASSES) {
+    return arenaMalloc(size);
+  }
+  const size_t class = (size - 1) / SLAB_GRANULE;
+  SLAB_STATISTICS.allocs += 1;
+  if (size == 0 || class >= SLAB_CLASSES) {
+    SLAB_STATISTICS.fallbacks += 1;
+    return a404m_malloc(size);
+  }
+
+  SlabFree *object = SLAB_FREE_LISTS[class];
+  if (object != NULL) {
+    SLAB_STATISTICS.hits += 1;
+  } else {
+    slabRefill(class);
+    object = SLAB_FREE_LISTS[class];
+  }
+  SLAB_FREE_LISTS[class] = object->next;
+  return object;
+}
+
+void a404m_slab_free(void *pointer, size_t size) {
+  const size_t class = (size - 1) / SLAB_GRANULE;
+  if (pointer == NULL) {
+    return;
+  }
+  const ArenaTag *tag = arenaTag(pointer);
+  if (tag != NULL) {
+    // a block that outlived its arena was missed by the escape copies
+    if (ARENA_DEPTH == 0 || tag->generation != ARENA_GENERATION) {
+      printLog("Freeing a block of a closed arena");
+      UNREACHABLE;
+    }
+    return;
+  } else if (size == 0 || class >= SLAB_CLASSES) {
+    free(pointer);
+    return;
+  }
+  SLAB_STATISTICS.frees += 1;
+
+  SlabFree *object = pointer;
+  object->next = SLAB_FREE_LISTS[class];
+  SLAB_FREE_LISTS[class] = object;
+}
+
+#else
+
+void *a404m_slab_malloc(size_t size) { return a404m_malloc(size); }
+
+void a404m_slab_free(void *pointer, size_t size) {
+  (void)size;
+  free(pointer);
+}
+
+void a404m_arena_open() {}
+
+void a404m_arena_close() {}
+
+bool a404m_arena_owns(void *pointer) {
+  (void)pointer;
+  return false;
+}
+
+bool a404m_arena_pause() { return false; }
+
+void a404m_arena_resume(bool wasOpen) { (void)wasOpen; }
+
+#endif
+
+SlabStatistics a404m_slab_statistics() {
+#ifdef SLAB_ALLOCATOR
+  return SLAB_STATISTICS;
+#else
+  return (SlabStatistics){0};
+#endif
+}
+
+#define FRAME_CHUNK_SIZE (64 * 1024)
+#define FRAME_ALIGN 16
+
+typedef struct FrameChunk {
+  struct FrameChunk *next;
+  size_t capacity;
+  size_t used;
+  max_align_t data[];
+} FrameChunk;
+
+// chunks in use are from FRAME_FIRST to FRAME_CURRENT, the rest are kept for
+// the next frames
+static _Thread_local FrameChunk *FRAME_FIRST = NULL;
+static _Thread_local FrameChunk *FRAME_CURRENT = NULL;
+
+static FrameChunk *frameNewChunk(size_t size, FrameChunk *next) {
+  const size_t capacity = size > FRAME_CHUNK_SIZE - sizeof(FrameChunk)
+                              ? size
+                              : FRAME_CHUNK_SIZE - sizeof(FrameChunk);
+  FrameChunk *chunk = a404m_malloc(sizeof(*chunk) + capacity);
+  chunk->next = next;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  return chunk;
+}
+
+FrameMark a404m_frame_mark() {
+  return (FrameMark){
+      .chunk = FRAME_CURRENT,
+      .used = FRAME_CURRENT == NULL ? 0 : FRAME_CURRENT->used,
+  };
+}
+
+void *a404m_frame_alloc(size_t size) {
+  size = (size + FRAME_ALIGN - 1) & ~(size_t)(FRAME_ALIGN - 1);
+  if (FRAME_CURRENT == NULL) {
+    if (FRAME_FIRST == NULL || FRAME_FIRST->capacity < size) {
+      FRAME_FIRST = frameNewChunk(size, FRAME_FIRST);
+    }
+    FRAME_CURRENT = FRAME_FIRST;
+    FRAME_CURRENT->used = 0;
+  }
+  if (FRAME_CURRENT->used + size > FRAME_CURRENT->capacity) {
+    FrameChunk *next = FRAME_CURRENT->next;
+    if (next == NULL || next->capacity < size) {
+      // too small chunks stay after the new one for smaller requests
+      next = frameNewChunk(size, next);
+      FRAME_CURRENT->next = next;
+    }
+    FRAME_CURRENT = next;
+    FRAME_CURRENT->used = 0;
+  }
+  void *pointer = (u8 *)FRAME_CURRENT->data + FRAME_CURRENT->used;
+  FRAME_CURRENT->used += size;
+  return pointer;
+}
+
+// the chunk after the mark and where in it the memory of the frame begins
+static FrameChunk *frameFirstSince(FrameMark mark, size_t *from) {
+  if (mark.chunk == NULL) {
+    *from = 0;
+    return FRAME_CURRENT == NULL ? NULL : FRAME_FIRST;
+  }
+  *from = mark.used;
+  return mark.chunk;
+}
+
+void a404m_frame_release(FrameMark mark) {
+#ifndef NDEBUG
+  size_t from;
+  for (FrameChunk *chunk = frameFirstSince(mark, &from); chunk != NULL;
+       chunk = chunk->next, from = 0) {
+    memset((u8 *)chunk->data + from, FRAME_POISON, chunk->used - from);
+    if (chunk == FRAME_CURRENT) {
+      break;
+    }
+  }
+#endif
+  FRAME_CURRENT = mark.chunk;
+  if (FRAME_CURRENT != NULL) {
+    FRAME_CURRENT->used = mark.used;
+  }
+}
+
+bool a404m_frame_owns(FrameMark mark, const void *pointer) {
+  size_t from;
+  for (FrameChunk *chunk = frameFirstSince(mark, &from); chunk != NULL;
+       chunk = chunk->next, from = 0) {
+    const u8 *begin = (u8 *)chunk->data + from;
+    if ((const u8 *)pointer >= begin &&
+        (const u8 *)pointer < (u8 *)chunk->data + chunk->used) {
+      return true;
+    } else if (chunk == FRAME_CURRENT) {
+      break;
+    }
+  }
+  return false;
+}
+
+#define HEAP_MIN_SHIFT 4 // 16 bytes
+#define HEAP_CLASSES 13  // blocks up to 64KiB
+
+typedef union HeapHeader {
+  struct {
+    // next live block in the same bucket of HEAP_BLOCKS
+    union HeapHeader *next;
+    size_t class; // HEAP_CLASSES for blocks that are too big for the classes
+    size_t size;
+  };
+  max_align_t align;
+} HeapHeader;
+
+typedef struct HeapFree {
+  struct HeapFree *next;
+} HeapFree;
+
+static _Thread_local HeapFree *HEAP_FREE_LISTS[HEAP_CLASSES];
+
+// live blocks by their address, a pointer is only read as a block after it is
+// found here and blocks can be freed by any thread
+static struct {
+  HeapHeader **buckets;
+  size_t buckets_size; // a power of two
+  size_t size;
+} HEAP_BLOCKS = {
+    .buckets = NULL,
+    .buckets_size = 0,
+    .size = 0,
+};
+static HeapStatistics HEAP_STATISTICS = {0};
+static pthread_mutex_t HEAP_MUTEX = PTHREAD_MUTEX_INITIALIZER;
+
+static HeapHeader **heapBucket(const void *pointer) {
+  const u64 hash = (u64)(uintptr_t)pointer * 0x9e3779b97f4a7c15ULL;
+  return &HEAP_BLOCKS.buckets[(hash >> 32) & (HEAP_BLOCKS.buckets_size - 1)];
+}
+
+static void heapRegister(HeapHeader *header) {
+  if (HEAP_BLOCKS.size >= HEAP_BLOCKS.buckets_size) {
+    HeapHeader **oldBuckets = HEAP_BLOCKS.buckets;
+    const size_t oldBuckets_size = HEAP_BLOCKS.buckets_size;
+    HEAP_BLOCKS.buckets_size =
+        oldBuckets_size == 0 ? 64 : oldBuckets_size * 2;
+    HEAP_BLOCKS.buckets = a404m_malloc(HEAP_BLOCKS.buckets_size *
+                                       sizeof(*HEAP_BLOCKS.buckets));
+    memset(HEAP_BLOCKS.buckets, 0,
+           HEAP_BLOCKS.buckets_size * sizeof(*HEAP_BLOCKS.buckets));
+    for (size_t i = 0; i < oldBuckets_size; ++i) {
+      while (oldBuckets[i] != NULL) {
+        HeapHeader *block = oldBuckets[i];
+        oldBuckets[i] = block->next;
+        HeapHeader **bucket = heapBucket(block + 1);
+        block->next = *bucket;
+        *bucket = block;
+      }
+    }
+    free(oldBuckets);
+  }
+  HeapHeader **bucket = heapBucket(header + 1);
+  header->next = *bucket;
+  *bucket = header;
+  HEAP_BLOCKS.size += 1;
+}
+
+static HeapHeader *heapUnregister(const void *pointer) {
+  if (HEAP_BLOCKS.size == 0) {
+    return NULL;
+  }
+  for (HeapHeader **it = heapBucket(pointer); *it != NULL;
+       it = &(*it)->next) {
+    HeapHeader *header = *it;
+    if (header + 1 == pointer) {
+      *it = header->next;
+      HEAP_BLOCKS.size -= 1;
+      return header;
+    }
+  }
+  return NULL;
+}
+
+void *a404m_heap_malloc(size_t size) {
+  size_t class = 0;
+  while (class < HEAP_CLASSES &&
+         ((size_t)1 << (class + HEAP_MIN_SHIFT)) < size) {
+    class += 1;
+  }
+
+  HeapHeader *header;
+  bool hit = false;
+  if (class == HEAP_CLASSES) {
+    header = a404m_malloc(sizeof(*header) + size);
+  } else if (HEAP_FREE_LISTS[class] != NULL) {
+    HeapFree *block = HEAP_FREE_LISTS[class];
+    HEAP_FREE_LISTS[class] = block->next;
+    header = (HeapHeader *)block - 1;
+    hit = true;
+  } else {
+    header = a404m_malloc(sizeof(*header) +
+                          ((size_t)1 << (class + HEAP_MIN_SHIFT)));
+  }
+  header->class = class;
+  header->size = size;
+  memset(header + 1, 0, size);
+
+  pthread_mutex_lock(&HEAP_MUTEX);
+  heapRegister(header);
+  HEAP_STATISTICS.allocs += 1;
+  HEAP_STATISTICS.hits += hit;
+  HEAP_STATISTICS.liveBytes += size;
+  if (HEAP_STATISTICS.liveBytes > HEAP_STATISTICS.peakBytes) {
+    HEAP_STATISTICS.peakBytes = HEAP_STATISTICS.liveBytes;
+  }
+  pthread_mutex_unlock(&HEAP_MUTEX);
+
+  return header + 1;
+}
+
+bool a404m_heap_free(void *pointer) {
+  pthread_mutex_lock(&HEAP_MUTEX);
+  HeapHeader *header = heapUnregister(pointer);
+  if (header != NULL) {
+    HEAP_STATISTICS.frees += 1;
+    HEAP_STATISTICS.liveBytes -= header->size;
+  }
+  pthread_mutex_unlock(&HEAP_MUTEX);
+  if (header == NULL) {
+    return false;
+  }
+
+  // blocks of other threads go to the free lists of this one
+  if (header->class == HEAP_CLASSES) {
+    free(header);
+  } else {
+    HeapFree *block = pointer;
+    block->next = HEAP_FREE_LISTS[header->class];
+    HEAP_FREE_LISTS[header->class] = block;
+  }
+  return true;
+}
+
+HeapStatistics a404m_heap_statistics() {
+  pthread_mutex_lock(&HEAP_MUTEX);
+  const HeapStatistics statistics = HEAP_STATISTICS;
+  pthread_mutex_unlock(&HEAP_MUTEX);
+  return statistics;
+}
+
+void a404m_thread_exit() {
+#ifdef SLAB_ALLOCATOR
+  if (SLAB_CHUNKS != NULL) {
+    SlabChunk *last = SLAB_CHUNKS;
+    while (last->next != NULL) {
+      last = last->next;
+    }
+    pthread_mutex_lock(&SLAB_ORPHAN_MUTEX);
+    last->next = SLAB_ORPHAN_CHUNKS;
+    SLAB_ORPHAN_CHUNKS = SLAB_CHUNKS;
+    pthread_mutex_unlock(&SLAB_ORPHAN_MUTEX);
+    SLAB_CHUNKS = NULL;
+  }
+  for (size_t i = 0; i < SLAB_CLASSES; ++i) {
+    SLAB_FREE_LISTS[i] = NULL;
+  }
+
+  while (ARENA_FIRST != NULL) {
+    ArenaChunk *next = ARENA_FIRST->next;
+    free(ARENA_FIRST);
+    ARENA_FIRST = next;
+  }
+  ARENA_CURRENT = NULL;
+#endif
+
+  while (FRAME_FIRST != NULL) {
+    FrameChunk *next = FRAME_FIRST->next;
+    free(FRAME_FIRST);
+    FRAME_FIRST = next;
+  }
+  FRAME_CURRENT = NULL;
+
+  for (size_t i = 0; i < HEAP_CLASSES; ++i) {
+    while (HEAP_FREE_LISTS[i] != NULL) {
+      HeapFree *block = HEAP_FREE_LISTS[i];
+      HEAP_FREE_LISTS[i] = block->next;
+      free((HeapHeader *)block - 1);
+    }
+  }
+}
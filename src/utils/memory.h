@@ -5,3 +5,76 @@
 extern void *a404m_malloc(size_t size);
 extern void *a404m_realloc(void *pointer, size_t size);
 extern size_t a404m_malloc_usable_size(void *pointer);
+
+// size class allocator for small objects that are made and freed a lot like
+// AstTree and its scalar metadata, the size given to a404m_slab_free must be
+// the same as the one given to a404m_slab_malloc
+// without SLAB_ALLOCATOR these are malloc and free
+extern void *a404m_slab_malloc(size_t size);
+extern void a404m_slab_free(void *pointer, size_t size);
+
+// bump arena for short lived objects, while it is open a404m_slab_malloc takes
+// from it and a404m_slab_free ignores what it gave, closing the outermost one
+// releases all of them at once
+// pausing lets objects that outlive the arena to be made while it is open
+// blocks are tagged with the opening of the arena that made them, freeing one
+// after its arena was closed is an error instead of a silent reuse
+extern void a404m_arena_open();
+extern void a404m_arena_close();
+extern bool a404m_arena_owns(void *pointer);
+extern bool a404m_arena_pause();
+extern void a404m_arena_resume(bool wasOpen);
+
+typedef struct SlabStatistics {
+  size_t allocs;
+  size_t hits;
+  size_t frees;
+  size_t chunks;
+  size_t fallbacks;
+  size_t arenaAllocs;
+  size_t arenaResets;
+} SlabStatistics;
+
+// counters of the calling thread
+extern SlabStatistics a404m_slab_statistics();
+
+// bump region of the calling thread for memory that lives until its call frame
+// returns, a frame takes a mark when it starts and releases it when it returns
+// which frees everything allocated after the mark
+typedef struct FrameMark {
+  struct FrameChunk *chunk;
+  size_t used;
+} FrameMark;
+
+extern FrameMark a404m_frame_mark();
+extern void *a404m_frame_alloc(size_t size);
+// without NDEBUG the released memory is overwritten with FRAME_POISON so reads
+// through a view that outlived its frame are easy to see
+extern void a404m_frame_release(FrameMark mark);
+// whether the pointer is in memory allocated after the mark
+extern bool a404m_frame_owns(FrameMark mark, const void *pointer);
+
+#define FRAME_POISON 0xdb
+
+// size class heap for @heapAlloc, blocks are cached in thread local free lists
+// of their class when freed and big ones go to malloc
+// memory is zeroed, live blocks are kept in a registry shared by the threads so
+// a404m_heap_free returns false for any pointer that is not one of them
+extern void *a404m_heap_malloc(size_t size);
+extern bool a404m_heap_free(void *pointer);
+
+typedef struct HeapStatistics {
+  size_t allocs;
+  size_t frees;
+  size_t hits;
+  size_t liveBytes;
+  size_t peakBytes;
+} HeapStatistics;
+
+// counters of all threads
+extern HeapStatistics a404m_heap_statistics();
+
+// frees what the calling thread keeps for its next allocations, threads that
+// @spawn made call it before they exit, slab chunks are kept since objects in
+// them can be used by other threads
+extern void a404m_thread_exit();
@@ -0,0 +1,118 @@
+#include "output.h"
+
+#include "utils/memory.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static u8 *output = NULL;
+static size_t output_size = 0;
+static size_t output_capacity = 0;
+static bool output_flushOnNewline = false;
+// threads of @spawn share the buffer, it is only locked once one is spawned
+static pthread_mutex_t output_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool output_shared = false;
+static _Thread_local OutputBuffer *output_capture = NULL;
+
+static void outputFlushLocked() {
+  size_t written = 0;
+  while (written < output_size) {
+    const ssize_t res =
+        write(STDOUT_FILENO, output + written, output_size - written);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    written += res;
+  }
+  output_size = 0;
+}
+
+void outputInit(size_t size, bool flushOnNewline) {
+  output_capacity = size == 0 ? 1 : size;
+  output = a404m_malloc(output_capacity * sizeof(*output));
+  output_size = 0;
+  output_flushOnNewline = flushOnNewline;
+  // runtime errors exit without returning to main
+  atexit(outputDelete);
+}
+
+// registered with atexit and also called at the end of main
+void outputDelete() {
+  if (output == NULL) {
+    return;
+  }
+  outputFlush();
+  free(output);
+  output = NULL;
+  output_capacity = 0;
+}
+
+static void outputCapturePush(const u8 *data, size_t size) {
+  const size_t capacity = a404m_malloc_usable_size(output_capture->data);
+  if (output_capture->size + size > capacity) {
+    size_t new_capacity = capacity + capacity / 2 + 1;
+    if (new_capacity < output_capture->size + size) {
+      new_capacity = output_capture->size + size;
+    }
+    output_capture->data = a404m_realloc(output_capture->data, new_capacity);
+  }
+  memcpy(output_capture->data + output_capture->size, data, size);
+  output_capture->size += size;
+}
+
+void outputPutc(u8 c) {
+  if (output_capture != NULL) {
+    outputCapturePush(&c, 1);
+    return;
+  }
+  const bool shared = __atomic_load_n(&output_shared, __ATOMIC_RELAXED);
+  if (shared) {
+    pthread_mutex_lock(&output_mutex);
+  }
+  output[output_size++] = c;
+  if (output_size == output_capacity ||
+      (output_flushOnNewline && c == '\n')) {
+    outputFlushLocked();
+  }
+  if (shared) {
+    pthread_mutex_unlock(&output_mutex);
+  }
+}
+
+void outputWrite(const u8 *data, size_t size) {
+  if (output_capture != NULL) {
+    outputCapturePush(data, size);
+    return;
+  }
+  const bool shared = __atomic_load_n(&output_shared, __ATOMIC_RELAXED);
+  if (shared) {
+    pthread_mutex_lock(&output_mutex);
+  }
+  for (size_t i = 0; i < size; ++i) {
+    output[output_size++] = data[i];
+    if (output_size == output_capacity ||
+        (output_flushOnNewline && data[i] == '\n')) {
+      outputFlushLocked();
+    }
+  }
+  if (shared) {
+    pthread_mutex_unlock(&output_mutex);
+  }
+}
+
+void outputCapture(OutputBuffer *buffer) { output_capture = buffer; }
+
+void outputShare() {
+  __atomic_store_n(&output_shared, true, __ATOMIC_RELAXED);
+}
+
+void outputFlush() {
+  pthread_mutex_lock(&output_mutex);
+  outputFlushLocked();
+  pthread_mutex_unlock(&output_mutex);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "utils/type.h"
+#include <stddef.h>
+
+#define OUTPUT_DEFAULT_SIZE (64 * 1024)
+
+void outputInit(size_t size, bool flushOnNewline);
+void outputDelete();
+
+void outputPutc(u8 c);
+void outputWrite(const u8 *data, size_t size);
+void outputFlush();
+
+typedef struct OutputBuffer {
+  u8 *data;
+  size_t size;
+} OutputBuffer;
+
+// output of the calling thread goes to the buffer until it is called with NULL
+void outputCapture(OutputBuffer *buffer);
+
+// called before a thread that writes to the output is spawned, the output is
+// not locked until then
+void outputShare();